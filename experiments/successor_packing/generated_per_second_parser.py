@@ -0,0 +1,16 @@
+#! /usr/bin/env python
+
+from lab.parser import Parser
+
+
+def add_generated_per_second(content, props):
+    generated = props.get("generated")
+    search_time = props.get("search_time")
+    if generated is not None and search_time:
+        props["generated_per_second"] = generated / search_time
+
+
+# Uses the attributes "generated" and "search_time" of the search parser.
+parser = Parser()
+parser.add_function(add_generated_per_second)
+parser.parse()
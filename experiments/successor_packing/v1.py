@@ -0,0 +1,65 @@
+#! /usr/bin/env python
+
+"""
+Measure how many states per second the search generates before and after
+applying operator effects directly to the packed state data in
+StateRegistry::get_successor_state.
+
+Blind search spends most of its time generating successors. We stop the
+searches after a fixed time so that unsolved tasks with many state
+variables contribute measurements, too.
+"""
+
+import os
+
+from lab.environments import LocalEnvironment, BaselSlurmEnvironment
+
+import common_setup
+from common_setup import IssueConfig, IssueExperiment
+
+DIR = os.path.dirname(os.path.abspath(__file__))
+SCRIPT_NAME = os.path.splitext(os.path.basename(__file__))[0]
+BENCHMARKS_DIR = os.environ["DOWNWARD_BENCHMARKS"]
+# The revision before the change and the revision with the change.
+REVISIONS = ["9a1a17e", "HEAD"]
+CONFIGS = [
+    IssueConfig("blind", ["--search", "astar(blind(), max_time=60)"]),
+    IssueConfig("gbfs-ff", ["--search", "eager_greedy([ff()], max_time=60)"]),
+]
+
+# Tasks with many state variables, axioms and conditional effects.
+SUITE = [
+    "logistics98", "pipesworld-tankage", "psr-large", "satellite",
+    "scanalyzer-08-strips", "visitall-sat11-strips", "miconic-fulladl",
+    "philosophers", "optical-telegraphs", "airport"]
+ENVIRONMENT = BaselSlurmEnvironment(
+    partition="infai_2",
+    export=["PATH", "DOWNWARD_BENCHMARKS"])
+
+if common_setup.is_test_run():
+    SUITE = IssueExperiment.DEFAULT_TEST_SUITE
+    ENVIRONMENT = LocalEnvironment(processes=1)
+
+exp = IssueExperiment(
+    revisions=REVISIONS,
+    configs=CONFIGS,
+    environment=ENVIRONMENT,
+)
+exp.add_suite(BENCHMARKS_DIR, SUITE)
+
+exp.add_parser(exp.EXITCODE_PARSER)
+exp.add_parser(exp.SINGLE_SEARCH_PARSER)
+exp.add_parser(exp.PLANNER_PARSER)
+exp.add_parser(os.path.join(DIR, "generated_per_second_parser.py"))
+
+exp.add_step('build', exp.build)
+exp.add_step('start', exp.start_runs)
+exp.add_fetcher(name='fetch')
+
+attributes = IssueExperiment.DEFAULT_TABLE_ATTRIBUTES + [
+    "generated_per_second"]
+exp.add_comparison_table_step(attributes=attributes)
+exp.add_scatter_plot_step(
+    relative=True, attributes=["generated_per_second", "search_time"])
+
+exp.run_steps()
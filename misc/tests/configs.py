@@ -59,6 +59,13 @@ def configs_optimal_core():
             "--search", "astar(blind(), pruning=stubborn_sets_ec())"],
         "blind-atom-centric-sss": [
             "--search", "astar(blind(), pruning=atom_centric_stubborn_sets())"],
+        # hash-distributed A*
+        "hdastar_lmcut": [
+            "--search",
+            "hdastar(lmcut(), threads=2)"],
+        "astar_blind_no_parents": [
+            "--search",
+            "astar(blind(), store_parents=false)"],
     }
 
 
@@ -121,6 +128,53 @@ def configs_satisficing_core():
                 "single(hlm), single(hlm, pref_only=true), type_based([hff, g()])], boost=1000),"
                 "preferred=[hff,hlm], cost_type=one, reopen_closed=false, randomize_successors=true,"
                 "preferred_successors_first=false)"],
+        # monte carlo tree search
+        "mcts_ff_threads": [
+            "--search",
+            "mcts(ff(), threads=2)"],
+        # parallel portfolio
+        "parallel_portfolio_ff_add": [
+            "--search",
+            "parallel_portfolio([lazy_greedy([ff()]), eager_greedy([add()])],"
+            "continue_on_solve=true)"],
+        # state storage
+        "eager_greedy_ff_zobrist": [
+            "--search",
+            "eager_greedy([ff()], zobrist_hashing=true)"],
+        "eager_greedy_ff_compressed_states": [
+            "--search",
+            "eager_greedy([ff()], compress_states=true)"],
+        "eager_greedy_ff_compact_states": [
+            "--search",
+            "eager_greedy([ff()], store_parents=false, compress_states=true,"
+            "zobrist_hashing=true)"],
+        # parallel greedy best-first search
+        "parallel_greedy_ff": [
+            "--search",
+            "parallel_greedy(ff(), threads=2)"],
+        # lazy greedy with lookahead
+        "lazy_greedy_ff_lookahead": [
+            "--evaluator",
+            "h=ff()",
+            "--search",
+            "lazy_greedy([h],preferred=[h],lookahead=8)"],
+        "lazy_greedy_ff_lookahead_no_pref": [
+            "--search",
+            "lazy_greedy([ff()], lookahead=8)"],
+        # parallel ehc
+        "ehc_ff_threads": [
+            "--search",
+            "ehc(ff(), threads=2)"],
+        # anytime weighted A*
+        "anytime_wastar_ff": [
+            "--search",
+            "anytime_wastar(ff())"],
+        "anytime_wastar_ff_no_restart": [
+            "--search",
+            "anytime_wastar(ff(), restart=false)"],
+        "anytime_wastar_ff_plusone": [
+            "--search",
+            "anytime_wastar(ff(), cost_type=plusone)"],
     }
 
 
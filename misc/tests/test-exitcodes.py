@@ -95,6 +95,9 @@ SEARCH_TESTS = [
         defaultdict(lambda: returncodes.SEARCH_UNSUPPORTED)),
     ("axioms", [], MERGE_AND_SHRINK,
         defaultdict(lambda: returncodes.SEARCH_UNSUPPORTED)),
+    # Without parent pointers, plans are traced by regression.
+    ("axioms", [], "astar(add(), store_parents=false)",
+        defaultdict(lambda: returncodes.SUCCESS)),
     ("cond-eff", [], "astar(add())",
         defaultdict(lambda: returncodes.SUCCESS)),
     ("cond-eff", [], "astar(hm())",
@@ -121,6 +124,8 @@ SEARCH_TESTS = [
         defaultdict(lambda: returncodes.SEARCH_UNSUPPORTED)),
     ("cond-eff", [], MERGE_AND_SHRINK,
         defaultdict(lambda: returncodes.SUCCESS)),
+    ("cond-eff", [], "astar(add(), store_parents=false)",
+        defaultdict(lambda: returncodes.SUCCESS)),
     # We cannot set/enforce memory limits on Windows/macOS and thus expect
     # DRIVER_UNSUPPORTED as exit code in those cases.
     ("large", ["--search-memory-limit", "100M"], MERGE_AND_SHRINK,
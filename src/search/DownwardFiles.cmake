@@ -51,6 +51,7 @@ fast_downward_plugin(
         abstract_task
         axioms
         command_line
+        concurrent_per_state_information
         evaluation_context
         evaluation_result
         evaluator
@@ -79,7 +80,7 @@ fast_downward_plugin(
         task_id
         task_proxy
 
-    DEPENDS CAUSAL_GRAPH INT_HASH_SET INT_PACKER ORDERED_SET SEGMENTED_VECTOR SUBSCRIBER SUCCESSOR_GENERATOR TASK_PROPERTIES
+    DEPENDS CAUSAL_GRAPH EFFECT_PACKER INT_HASH_SET INT_PACKER ORDERED_SET SEGMENTED_VECTOR SUBSCRIBER SUCCESSOR_GENERATOR TASK_PROPERTIES ZOBRIST_HASHER
     CORE_PLUGIN
 )
 
@@ -113,6 +114,7 @@ fast_downward_plugin(
         utils/hash
         utils/language
         utils/logging
+        utils/mapped_file_pool
         utils/markup
         utils/math
         utils/memory
@@ -224,6 +226,22 @@ fast_downward_plugin(
     DEPENDENCY_ONLY
 )
 
+fast_downward_plugin(
+    NAME MULTI_QUEUE
+    HELP "Relaxed priority queue for several threads"
+    SOURCES
+        algorithms/multi_queue
+    DEPENDENCY_ONLY
+)
+
+fast_downward_plugin(
+    NAME MPSC_QUEUE
+    HELP "Lock-free queue for several producers and one consumer"
+    SOURCES
+        algorithms/mpsc_queue
+    DEPENDENCY_ONLY
+)
+
 fast_downward_plugin(
     NAME ORDERED_SET
     HELP "Set of elements ordered by insertion time"
@@ -236,6 +254,8 @@ fast_downward_plugin(
     NAME SEGMENTED_VECTOR
     HELP "Memory-friendly and vector-like data structure"
     SOURCES
+        algorithms/compressible_segmented_vector
+        algorithms/concurrent_segmented_vector
         algorithms/segmented_vector
     DEPENDENCY_ONLY
 )
@@ -368,6 +388,14 @@ fast_downward_plugin(
     DEPENDENCY_ONLY
 )
 
+fast_downward_plugin(
+    NAME PARALLEL_SEARCH_COMMON
+    HELP "Basic functions used for search engines with several worker threads"
+    SOURCES
+        search_engines/parallel_search_common
+    DEPENDENCY_ONLY
+)
+
 fast_downward_plugin(
     NAME EAGER_SEARCH
     HELP "Eager search algorithm"
@@ -377,6 +405,22 @@ fast_downward_plugin(
     DEPENDENCY_ONLY
 )
 
+fast_downward_plugin(
+    NAME HDASTAR
+    HELP "Hash-distributed A* search"
+    SOURCES
+        search_engines/hash_distributed_astar_search
+    DEPENDS MPSC_QUEUE PARALLEL_SEARCH_COMMON SEARCH_COMMON
+)
+
+fast_downward_plugin(
+    NAME PARALLEL_GREEDY
+    HELP "Parallel greedy best-first search"
+    SOURCES
+        search_engines/parallel_greedy_search
+    DEPENDS MULTI_QUEUE PARALLEL_SEARCH_COMMON
+)
+
 fast_downward_plugin(
     NAME PLUGIN_ASTAR
     HELP "A* search"
@@ -414,9 +458,51 @@ fast_downward_plugin(
     HELP "Monte Carlo Tree search"
     SOURCES
         search_engines/monte_carlo_tree_search
+        treesearch_child_arena
         treesearch_space
         treesearch_node_info
-    DEPENDS SEARCH_COMMON
+        treesearch_statistics
+    DEPENDS EPSILON_GREEDY_TREE_SELECTION PARALLEL_SEARCH_COMMON SEARCH_COMMON
+)
+
+fast_downward_plugin(
+    NAME TREE_SELECTION_POLICY
+    HELP "Base class for selection policies of tree searches"
+    SOURCES
+        tree_selection_policy
+    DEPENDENCY_ONLY
+)
+
+fast_downward_plugin(
+    NAME EPSILON_GREEDY_TREE_SELECTION
+    HELP "Epsilon-greedy selection policy for tree searches"
+    SOURCES
+        tree_selection/epsilon_greedy_selection
+    DEPENDS TREE_SELECTION_POLICY
+)
+
+fast_downward_plugin(
+    NAME GBFS_TREE_SELECTION
+    HELP "Greedy best-first selection policy for tree searches"
+    SOURCES
+        tree_selection/gbfs_selection
+    DEPENDS TREE_SELECTION_POLICY
+)
+
+fast_downward_plugin(
+    NAME SOFTMIN_TREE_SELECTION
+    HELP "Softmin (Boltzmann) selection policy for tree searches"
+    SOURCES
+        tree_selection/softmin_selection
+    DEPENDS TREE_SELECTION_POLICY
+)
+
+fast_downward_plugin(
+    NAME UCT_TREE_SELECTION
+    HELP "UCT selection policy for tree searches"
+    SOURCES
+        tree_selection/uct_selection
+    DEPENDS TREE_SELECTION_POLICY
 )
 
 
@@ -449,7 +535,15 @@ fast_downward_plugin(
     HELP "Lazy enforced hill-climbing search algorithm"
     SOURCES
         search_engines/enforced_hill_climbing_search
-    DEPENDS G_EVALUATOR ORDERED_SET PREF_EVALUATOR SEARCH_COMMON SUCCESSOR_GENERATOR
+    DEPENDS G_EVALUATOR ORDERED_SET PARALLEL_SEARCH_COMMON PREF_EVALUATOR SEARCH_COMMON SUCCESSOR_GENERATOR
+)
+
+fast_downward_plugin(
+    NAME ANYTIME_WEIGHTED_ASTAR_SEARCH
+    HELP "Anytime weighted A* search that keeps its search space between iterations"
+    SOURCES
+        search_engines/anytime_weighted_astar_search
+    DEPENDS SEARCH_COMMON SUCCESSOR_GENERATOR
 )
 
 fast_downward_plugin(
@@ -459,6 +553,13 @@ fast_downward_plugin(
         search_engines/iterated_search
 )
 
+fast_downward_plugin(
+    NAME PARALLEL_PORTFOLIO_SEARCH
+    HELP "Parallel portfolio of search algorithms"
+    SOURCES
+        search_engines/parallel_portfolio_search
+)
+
 fast_downward_plugin(
     NAME LAZY_SEARCH
     HELP "Lazy search algorithm"
@@ -606,6 +707,24 @@ fast_downward_plugin(
     DEPENDENCY_ONLY
 )
 
+fast_downward_plugin(
+    NAME EFFECT_PACKER
+    HELP "Application of operator effects to packed states"
+    SOURCES
+        task_utils/effect_packer
+    DEPENDS INT_PACKER TASK_PROPERTIES
+    DEPENDENCY_ONLY
+)
+
+fast_downward_plugin(
+    NAME ZOBRIST_HASHER
+    HELP "Incremental Zobrist hashing of packed states"
+    SOURCES
+        task_utils/zobrist_hasher
+    DEPENDS INT_HASH_SET INT_PACKER TASK_PROPERTIES
+    DEPENDENCY_ONLY
+)
+
 fast_downward_plugin(
     NAME SUCCESSOR_GENERATOR
     HELP "Successor generator"
@@ -0,0 +1,298 @@
+#ifndef ALGORITHMS_COMPRESSIBLE_SEGMENTED_VECTOR_H
+#define ALGORITHMS_COMPRESSIBLE_SEGMENTED_VECTOR_H
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/*
+  CompressibleSegmentedArrayVector is a variant of SegmentedArrayVector
+  (see segmented_vector.h) that can store old segments in compressed form
+  to trade CPU time for memory.
+
+  If compression is enabled, a segment is compressed as soon as
+  NUM_HOT_SEGMENTS newer segments have been started. The arrays of a
+  compressed segment are delta-encoded against the first array of the
+  segment (the reference): we XOR every array with the reference and
+  store a bitmask of the nonzero bytes, followed by these bytes. Arrays
+  that are appended at about the same time tend to be similar (e.g., the
+  successors of the same states), so most of their bytes match the
+  reference. To save memory, we only store the start of every
+  ARRAYS_PER_OFFSET-th encoded array and skip the encoded arrays before the
+  requested one when decoding. Segments that would not become smaller stay
+  uncompressed.
+
+  Arrays in uncompressed segments can be accessed through pointers as in
+  SegmentedArrayVector. Arrays in compressed segments can only be copied
+  (see copy_array). Pointers to the arrays of a segment become invalid
+  when the segment is compressed, i.e., after NUM_HOT_SEGMENTS further
+  segments have been started.
+
+  Like the other segmented vectors, the class takes an allocator for the
+  uncompressed segments (e.g., to place them in a memory-mapped file).
+  Compressed segments always use the standard allocator.
+*/
+
+namespace segmented_vector {
+template<class Element, class Allocator = std::allocator<Element>>
+class CompressibleSegmentedArrayVector {
+    typedef typename Allocator::template rebind<Element>::other ElementAllocator;
+
+    static_assert(std::is_trivially_copyable<Element>::value,
+                  "CompressibleSegmentedArrayVector stores elements as bytes");
+
+    static const std::size_t SEGMENT_BYTES = 8192;
+    static const std::size_t NUM_HOT_SEGMENTS = 16;
+    static const std::size_t ARRAYS_PER_OFFSET = 16;
+
+    using Offset = std::uint16_t;
+
+    struct Segment {
+        // Exactly one of raw_data and compressed_data is set.
+        Element *raw_data;
+        /*
+          The offsets of every ARRAYS_PER_OFFSET-th encoded array, the bytes
+          of the reference, and the encoded arrays.
+        */
+        std::unique_ptr<std::uint8_t[]> compressed_data;
+        std::size_t compressed_size;
+
+        explicit Segment(Element *raw_data)
+            : raw_data(raw_data),
+              compressed_size(0) {
+        }
+    };
+
+    const std::size_t elements_per_array;
+    const std::size_t bytes_per_array;
+    const std::size_t mask_bytes_per_array;
+    const std::size_t arrays_per_segment;
+    const std::size_t elements_per_segment;
+    const bool compress_cold_segments;
+
+    ElementAllocator element_allocator;
+    std::vector<Segment> segments;
+    std::size_t the_size;
+    std::size_t num_compressed_segments;
+    std::size_t compressed_bytes;
+
+    std::size_t get_segment(std::size_t index) const {
+        return index / arrays_per_segment;
+    }
+
+    std::size_t get_offset(std::size_t index) const {
+        return (index % arrays_per_segment) * elements_per_array;
+    }
+
+    std::size_t get_num_offsets() const {
+        return (arrays_per_segment + ARRAYS_PER_OFFSET - 1) / ARRAYS_PER_OFFSET;
+    }
+
+    void free_segment(Segment &segment) {
+        if (segment.raw_data) {
+            element_allocator.deallocate(segment.raw_data, elements_per_segment);
+            segment.raw_data = nullptr;
+        } else {
+            --num_compressed_segments;
+            compressed_bytes -= segment.compressed_size;
+        }
+    }
+
+    void compress_segment(Segment &segment) {
+        assert(segment.raw_data);
+        const std::uint8_t *raw_bytes =
+            reinterpret_cast<const std::uint8_t *>(segment.raw_data);
+        const std::uint8_t *reference = raw_bytes;
+        std::size_t raw_size = elements_per_segment * sizeof(Element);
+        std::size_t header_size = get_num_offsets() * sizeof(Offset);
+
+        std::vector<std::uint8_t> data(header_size);
+        data.insert(data.end(), reference, reference + bytes_per_array);
+        for (std::size_t i = 0; i < arrays_per_segment; ++i) {
+            if (data.size() >= raw_size ||
+                data.size() > std::numeric_limits<Offset>::max()) {
+                // Keep segments that do not become smaller uncompressed.
+                return;
+            }
+            if (i % ARRAYS_PER_OFFSET == 0) {
+                Offset offset = data.size();
+                std::memcpy(&data[i / ARRAYS_PER_OFFSET * sizeof(Offset)],
+                            &offset, sizeof(Offset));
+            }
+            std::size_t mask_start = data.size();
+            data.resize(data.size() + mask_bytes_per_array, 0);
+            const std::uint8_t *array = raw_bytes + i * bytes_per_array;
+            for (std::size_t byte = 0; byte < bytes_per_array; ++byte) {
+                std::uint8_t delta = array[byte] ^ reference[byte];
+                if (delta) {
+                    data[mask_start + byte / 8] |= 1 << (byte % 8);
+                    data.push_back(delta);
+                }
+            }
+        }
+        if (data.size() >= raw_size) {
+            return;
+        }
+        segment.compressed_data.reset(new std::uint8_t[data.size()]);
+        std::copy(data.begin(), data.end(), segment.compressed_data.get());
+        segment.compressed_size = data.size();
+        element_allocator.deallocate(segment.raw_data, elements_per_segment);
+        segment.raw_data = nullptr;
+        ++num_compressed_segments;
+        compressed_bytes += data.size();
+    }
+
+    void decompress_array(const Segment &segment, std::size_t index_in_segment,
+                          Element *result) const {
+        const std::uint8_t *data = segment.compressed_data.get();
+        Offset offset;
+        std::memcpy(&offset, data + index_in_segment / ARRAYS_PER_OFFSET * sizeof(Offset),
+                    sizeof(Offset));
+        const std::uint8_t *reference = data + get_num_offsets() * sizeof(Offset);
+        const std::uint8_t *mask = data + offset;
+        for (std::size_t i = 0; i < index_in_segment % ARRAYS_PER_OFFSET; ++i) {
+            std::size_t num_deltas = 0;
+            for (std::size_t byte = 0; byte < mask_bytes_per_array; ++byte) {
+                num_deltas += std::bitset<8>(mask[byte]).count();
+            }
+            mask += mask_bytes_per_array + num_deltas;
+        }
+        const std::uint8_t *delta = mask + mask_bytes_per_array;
+        std::uint8_t *result_bytes = reinterpret_cast<std::uint8_t *>(result);
+        for (std::size_t byte = 0; byte < bytes_per_array; ++byte) {
+            result_bytes[byte] = reference[byte];
+            if ((mask[byte / 8] >> (byte % 8)) & 1) {
+                result_bytes[byte] ^= *delta++;
+            }
+        }
+    }
+
+public:
+    CompressibleSegmentedArrayVector(
+        std::size_t elements_per_array_, bool compress_cold_segments,
+        const ElementAllocator &element_allocator = ElementAllocator())
+        : elements_per_array((assert(elements_per_array_ > 0),
+                              elements_per_array_)),
+          bytes_per_array(elements_per_array * sizeof(Element)),
+          mask_bytes_per_array((bytes_per_array + 7) / 8),
+          arrays_per_segment(
+              std::max(SEGMENT_BYTES / bytes_per_array, std::size_t(1))),
+          elements_per_segment(elements_per_array * arrays_per_segment),
+          compress_cold_segments(compress_cold_segments),
+          element_allocator(element_allocator),
+          the_size(0),
+          num_compressed_segments(0),
+          compressed_bytes(0) {
+    }
+
+    ~CompressibleSegmentedArrayVector() {
+        clear();
+    }
+
+    CompressibleSegmentedArrayVector(const CompressibleSegmentedArrayVector &) = delete;
+    CompressibleSegmentedArrayVector &operator=(
+        const CompressibleSegmentedArrayVector &) = delete;
+
+    bool compresses_cold_segments() const {
+        return compress_cold_segments;
+    }
+
+    bool is_compressed(std::size_t index) const {
+        assert(index < the_size);
+        return !segments[get_segment(index)].raw_data;
+    }
+
+    // The array must not be stored in a compressed segment.
+    Element *operator[](std::size_t index) {
+        assert(!is_compressed(index));
+        return segments[get_segment(index)].raw_data + get_offset(index);
+    }
+
+    // The array must not be stored in a compressed segment.
+    const Element *operator[](std::size_t index) const {
+        assert(!is_compressed(index));
+        return segments[get_segment(index)].raw_data + get_offset(index);
+    }
+
+    // Copy the array with the given index to result.
+    void copy_array(std::size_t index, Element *result) const {
+        assert(index < the_size);
+        const Segment &segment = segments[get_segment(index)];
+        if (segment.raw_data) {
+            const Element *array = segment.raw_data + get_offset(index);
+            std::copy(array, array + elements_per_array, result);
+        } else {
+            decompress_array(segment, index % arrays_per_segment, result);
+        }
+    }
+
+    std::size_t size() const {
+        return the_size;
+    }
+
+    void push_back(const Element *entry) {
+        std::size_t segment = get_segment(the_size);
+        if (segment == segments.size()) {
+            assert(get_offset(the_size) == 0);
+            segments.emplace_back(
+                element_allocator.allocate(elements_per_segment));
+            if (compress_cold_segments && segments.size() > NUM_HOT_SEGMENTS) {
+                compress_segment(segments[segments.size() - NUM_HOT_SEGMENTS - 1]);
+            }
+        }
+        std::copy(entry, entry + elements_per_array,
+                  segments[segment].raw_data + get_offset(the_size));
+        ++the_size;
+    }
+
+    void pop_back() {
+        assert(the_size > 0);
+        assert(!is_compressed(the_size - 1));
+        // The memory of the segment is kept for later push_back calls.
+        --the_size;
+    }
+
+    /*
+      Remove all arrays from position new_size on and deallocate the
+      segments that are no longer needed.
+    */
+    void truncate(std::size_t new_size) {
+        assert(new_size <= the_size);
+        the_size = new_size;
+        std::size_t num_needed_segments =
+            (the_size + arrays_per_segment - 1) / arrays_per_segment;
+        while (segments.size() > num_needed_segments) {
+            free_segment(segments.back());
+            segments.pop_back();
+        }
+        segments.shrink_to_fit();
+    }
+
+    void clear() {
+        truncate(0);
+    }
+
+    std::size_t get_num_segments() const {
+        return segments.size();
+    }
+
+    std::size_t get_num_compressed_segments() const {
+        return num_compressed_segments;
+    }
+
+    std::size_t estimate_memory_in_bytes() const {
+        std::size_t num_raw_segments = segments.size() - num_compressed_segments;
+        return num_raw_segments * elements_per_segment * sizeof(Element) +
+               compressed_bytes + segments.capacity() * sizeof(Segment);
+    }
+};
+}
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef ALGORITHMS_CONCURRENT_SEGMENTED_VECTOR_H
+#define ALGORITHMS_CONCURRENT_SEGMENTED_VECTOR_H
+
+#include "../utils/system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+/*
+  The classes in this file are variants of SegmentedVector and
+  SegmentedArrayVector (see segmented_vector.h) that can be accessed by
+  several threads at once.
+
+  Instead of a growing vector of segments, they use a two-level table of
+  segment pointers with a fixed layout. Segments are allocated on the
+  first access to one of their elements and published with
+  compare-and-swap, so looking up an element never takes a lock and
+  elements never move. Different threads may access different elements
+  concurrently; accessing the same element from several threads requires
+  external synchronization.
+
+  There is no notion of size: every index below the capacity can be
+  accessed, and the elements of a new segment are initialized with a
+  default value.
+*/
+
+namespace segmented_vector {
+template<class Element>
+class ConcurrentSegmentTable {
+    static const std::size_t SEGMENTS_PER_BLOCK = 1 << 12;
+    static const std::size_t MAX_BLOCKS = 1 << 14;
+
+    using SegmentPointer = std::atomic<Element *>;
+
+    const std::size_t segment_size;
+    std::allocator<Element> element_allocator;
+    std::unique_ptr<std::atomic<SegmentPointer *>[]> blocks;
+
+    void destroy_segment(Element *segment) {
+        for (std::size_t i = 0; i < segment_size; ++i) {
+            segment[i].~Element();
+        }
+        element_allocator.deallocate(segment, segment_size);
+    }
+
+    SegmentPointer *get_or_create_block(std::size_t block_index) {
+        if (block_index >= MAX_BLOCKS) {
+            utils::exit_with(utils::ExitCode::SEARCH_OUT_OF_MEMORY);
+        }
+        std::atomic<SegmentPointer *> &block_pointer = blocks[block_index];
+        SegmentPointer *block = block_pointer.load(std::memory_order_acquire);
+        if (!block) {
+            SegmentPointer *new_block = new SegmentPointer[SEGMENTS_PER_BLOCK];
+            for (std::size_t i = 0; i < SEGMENTS_PER_BLOCK; ++i) {
+                new_block[i].store(nullptr, std::memory_order_relaxed);
+            }
+            if (block_pointer.compare_exchange_strong(
+                    block, new_block, std::memory_order_acq_rel)) {
+                block = new_block;
+            } else {
+                // Another thread was faster; block now holds its block.
+                delete[] new_block;
+            }
+        }
+        return block;
+    }
+
+    // No implementation to forbid copies and assignment
+    ConcurrentSegmentTable(const ConcurrentSegmentTable<Element> &);
+    ConcurrentSegmentTable &operator=(const ConcurrentSegmentTable<Element> &);
+public:
+    explicit ConcurrentSegmentTable(std::size_t segment_size)
+        : segment_size(segment_size),
+          blocks(new std::atomic<SegmentPointer *>[MAX_BLOCKS]) {
+        for (std::size_t i = 0; i < MAX_BLOCKS; ++i) {
+            blocks[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~ConcurrentSegmentTable() {
+        for (std::size_t i = 0; i < MAX_BLOCKS; ++i) {
+            SegmentPointer *block = blocks[i].load(std::memory_order_relaxed);
+            if (block) {
+                for (std::size_t j = 0; j < SEGMENTS_PER_BLOCK; ++j) {
+                    Element *segment = block[j].load(std::memory_order_relaxed);
+                    if (segment) {
+                        destroy_segment(segment);
+                    }
+                }
+                delete[] block;
+            }
+        }
+    }
+
+    /*
+      Return the segment with the given index. If it does not exist yet,
+      create it with all elements set to default_value.
+    */
+    Element *get_or_create_segment(
+        std::size_t segment_index, const Element &default_value) {
+        SegmentPointer &segment_pointer =
+            get_or_create_block(segment_index / SEGMENTS_PER_BLOCK)[
+                segment_index % SEGMENTS_PER_BLOCK];
+        Element *segment = segment_pointer.load(std::memory_order_acquire);
+        if (!segment) {
+            Element *new_segment = element_allocator.allocate(segment_size);
+            std::uninitialized_fill_n(new_segment, segment_size, default_value);
+            if (segment_pointer.compare_exchange_strong(
+                    segment, new_segment, std::memory_order_acq_rel)) {
+                segment = new_segment;
+            } else {
+                destroy_segment(new_segment);
+            }
+        }
+        return segment;
+    }
+
+    // Return the segment with the given index, which must exist.
+    const Element *get_segment(std::size_t segment_index) const {
+        SegmentPointer *block = blocks[segment_index / SEGMENTS_PER_BLOCK].load(
+            std::memory_order_acquire);
+        assert(block);
+        const Element *segment = block[segment_index % SEGMENTS_PER_BLOCK].load(
+            std::memory_order_acquire);
+        assert(segment);
+        return segment;
+    }
+
+    std::size_t get_segment_size() const {
+        return segment_size;
+    }
+};
+
+
+template<class Entry>
+class ConcurrentSegmentedVector {
+    static const std::size_t SEGMENT_BYTES = 8192;
+    static const std::size_t SEGMENT_ELEMENTS =
+        (SEGMENT_BYTES / sizeof(Entry)) >= 1 ?
+        (SEGMENT_BYTES / sizeof(Entry)) : 1;
+
+    const Entry default_value;
+    ConcurrentSegmentTable<Entry> segments;
+public:
+    explicit ConcurrentSegmentedVector(const Entry &default_value = Entry())
+        : default_value(default_value),
+          segments(SEGMENT_ELEMENTS) {
+    }
+
+    Entry &operator[](std::size_t index) {
+        Entry *segment = segments.get_or_create_segment(
+            index / SEGMENT_ELEMENTS, default_value);
+        return segment[index % SEGMENT_ELEMENTS];
+    }
+};
+
+
+template<class Element>
+class ConcurrentSegmentedArrayVector {
+    static const std::size_t SEGMENT_BYTES = 8192;
+
+    const std::size_t elements_per_array;
+    const std::size_t arrays_per_segment;
+    ConcurrentSegmentTable<Element> segments;
+public:
+    explicit ConcurrentSegmentedArrayVector(std::size_t elements_per_array_)
+        : elements_per_array((assert(elements_per_array_ > 0),
+                              elements_per_array_)),
+          arrays_per_segment(
+              std::max(SEGMENT_BYTES / (elements_per_array * sizeof(Element)),
+                       std::size_t(1))),
+          segments(elements_per_array * arrays_per_segment) {
+    }
+
+    // New arrays are filled with value-initialized elements.
+    Element *operator[](std::size_t index) {
+        Element *segment = segments.get_or_create_segment(
+            index / arrays_per_segment, Element());
+        return segment + (index % arrays_per_segment) * elements_per_array;
+    }
+
+    // The array with the given index must have been accessed before.
+    const Element *operator[](std::size_t index) const {
+        const Element *segment = segments.get_segment(index / arrays_per_segment);
+        return segment + (index % arrays_per_segment) * elements_per_array;
+    }
+
+    std::size_t get_arrays_per_segment() const {
+        return arrays_per_segment;
+    }
+};
+}
+
+#endif
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <iostream>
 #include <limits>
 #include <utility>
@@ -280,6 +281,18 @@ public:
         return num_entries;
     }
 
+    /*
+      Remove all keys and release the memory of the buckets.
+    */
+    void clear() {
+        std::vector<Bucket>(1).swap(buckets);
+        num_entries = 0;
+    }
+
+    std::size_t estimate_memory_in_bytes() const {
+        return buckets.capacity() * sizeof(Bucket);
+    }
+
     /*
       Insert a key into the hash set.
 
@@ -292,6 +305,15 @@ public:
         return insert(key, hasher(key));
     }
 
+    /*
+      Return a key contained in the hash set that is equivalent to the
+      given key, or -1 if there is none.
+    */
+    KeyType find(KeyType key) const {
+        assert(key >= 0);
+        return find_equal_key(key, hasher(key));
+    }
+
     void dump(utils::LogProxy &log) const {
         int num_buckets = capacity();
         log << "[";
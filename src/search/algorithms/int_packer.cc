@@ -1,12 +1,51 @@
 #include "int_packer.h"
 
+#include <algorithm>
 #include <cassert>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define INT_PACKER_AVX2
+#include <immintrin.h>
+#endif
+
 using namespace std;
 
 namespace int_packer {
 static const int BITS_PER_BIN = sizeof(IntPacker::Bin) * 8;
 
+static void unpack_scalar(
+    const IntPacker::Bin *buffer, const int *bin_indices,
+    const unsigned int *shifts, const unsigned int *value_masks,
+    int num_vars, int *values) {
+    for (int var = 0; var < num_vars; ++var) {
+        values[var] = (buffer[bin_indices[var]] >> shifts[var]) & value_masks[var];
+    }
+}
+
+#ifdef INT_PACKER_AVX2
+__attribute__((target("avx2")))
+static void unpack_avx2(
+    const IntPacker::Bin *buffer, const int *bin_indices,
+    const unsigned int *shifts, const unsigned int *value_masks,
+    int num_vars, int *values) {
+    const int *bins = reinterpret_cast<const int *>(buffer);
+    int var = 0;
+    for (; var + 8 <= num_vars; var += 8) {
+        __m256i index = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(bin_indices + var));
+        __m256i shift = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(shifts + var));
+        __m256i mask = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(value_masks + var));
+        __m256i bin = _mm256_i32gather_epi32(bins, index, sizeof(int));
+        __m256i value = _mm256_and_si256(_mm256_srlv_epi32(bin, shift), mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(values + var), value);
+    }
+    unpack_scalar(buffer, bin_indices + var, shifts + var, value_masks + var,
+                  num_vars - var, values + var);
+}
+#endif
+
 static IntPacker::Bin get_bit_mask(int from, int to) {
     // Return mask with all bits in the range [from, to) set to 1.
     assert(from >= 0 && to >= from && to <= BITS_PER_BIN);
@@ -62,12 +101,42 @@ public:
         Bin &bin = buffer[bin_index];
         bin = (bin & clear_mask) | (value << shift);
     }
+
+    int get_bin_index() const {
+        return bin_index;
+    }
+
+    int get_shift() const {
+        return shift;
+    }
+
+    Bin get_value_mask() const {
+        return read_mask >> shift;
+    }
+
+    Bin get_clear_mask() const {
+        return clear_mask;
+    }
+
+    Bin get_value_bits(int value) const {
+        assert(value >= 0 && value < range);
+        return Bin(value) << shift;
+    }
 };
 
 
 IntPacker::IntPacker(const vector<int> &ranges)
-    : num_bins(0) {
+    : num_bins(0),
+      use_avx2(false) {
     pack_bins(ranges);
+    for (const VariableInfo &var_info : var_infos) {
+        bin_indices.push_back(var_info.get_bin_index());
+        shifts.push_back(var_info.get_shift());
+        value_masks.push_back(var_info.get_value_mask());
+    }
+#ifdef INT_PACKER_AVX2
+    use_avx2 = __builtin_cpu_supports("avx2");
+#endif
 }
 
 IntPacker::~IntPacker() {
@@ -81,6 +150,42 @@ void IntPacker::set(Bin *buffer, int var, int value) const {
     var_infos[var].set(buffer, value);
 }
 
+void IntPacker::unpack(const Bin *buffer, int *values) const {
+    int num_vars = var_infos.size();
+#ifdef INT_PACKER_AVX2
+    if (use_avx2) {
+        unpack_avx2(buffer, bin_indices.data(), shifts.data(),
+                    value_masks.data(), num_vars, values);
+        return;
+    }
+#endif
+    unpack_scalar(buffer, bin_indices.data(), shifts.data(),
+                  value_masks.data(), num_vars, values);
+}
+
+void IntPacker::pack(Bin *buffer, const int *values) const {
+    // Unused bits of half-full bins are set to 0.
+    fill_n(buffer, num_bins, 0);
+    int num_vars = var_infos.size();
+    for (int var = 0; var < num_vars; ++var) {
+        assert(values[var] >= 0 &&
+               static_cast<Bin>(values[var]) <= value_masks[var]);
+        buffer[bin_indices[var]] |= Bin(values[var]) << shifts[var];
+    }
+}
+
+int IntPacker::get_bin_index(int var) const {
+    return var_infos[var].get_bin_index();
+}
+
+IntPacker::Bin IntPacker::get_clear_mask(int var) const {
+    return var_infos[var].get_clear_mask();
+}
+
+IntPacker::Bin IntPacker::get_value_bits(int var, int value) const {
+    return var_infos[var].get_value_bits(value);
+}
+
 void IntPacker::pack_bins(const vector<int> &ranges) {
     assert(var_infos.empty());
 
@@ -0,0 +1,103 @@
+#ifndef ALGORITHMS_MPSC_QUEUE_H
+#define ALGORITHMS_MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+/*
+  MPSCQueue is a lock-free queue for several producer threads and a single
+  consumer thread.
+
+  Producers push batches of elements (vectors) to reduce the number of
+  atomic operations and allocations per element. Internally, the batches
+  form a linked stack whose head is updated with compare-and-swap. The
+  consumer takes the whole stack with a single atomic exchange and
+  reverses it, so the batches of every producer arrive in the order in
+  which they were pushed.
+
+  Pushing a batch publishes all memory writes of the producer that
+  happened before the push to the consumer that pops the batch.
+*/
+
+namespace mpsc_queue {
+template<class Element>
+class MPSCQueue {
+    struct Batch {
+        std::vector<Element> elements;
+        Batch *next;
+
+        Batch(std::vector<Element> &&elements, Batch *next)
+            : elements(std::move(elements)),
+              next(next) {
+        }
+    };
+
+    std::atomic<Batch *> head;
+
+    static void delete_batches(Batch *batch) {
+        while (batch) {
+            Batch *next = batch->next;
+            delete batch;
+            batch = next;
+        }
+    }
+
+public:
+    MPSCQueue()
+        : head(nullptr) {
+    }
+
+    MPSCQueue(const MPSCQueue<Element> &) = delete;
+    MPSCQueue &operator=(const MPSCQueue<Element> &) = delete;
+
+    ~MPSCQueue() {
+        delete_batches(head.load(std::memory_order_acquire));
+    }
+
+    // Can be called by any thread. The batch is left empty.
+    void push(std::vector<Element> &&elements) {
+        if (elements.empty()) {
+            return;
+        }
+        Batch *batch = new Batch(std::move(elements), head.load(std::memory_order_relaxed));
+        while (!head.compare_exchange_weak(
+                   batch->next, batch,
+                   std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        elements.clear();
+    }
+
+    /*
+      Append all elements in the queue to the given vector and remove them
+      from the queue. Must only be called by the consumer thread. Returns
+      false if the queue was empty.
+    */
+    bool pop_all(std::vector<Element> &result) {
+        Batch *batch = head.exchange(nullptr, std::memory_order_acquire);
+        if (!batch) {
+            return false;
+        }
+        Batch *reversed = nullptr;
+        while (batch) {
+            Batch *next = batch->next;
+            batch->next = reversed;
+            reversed = batch;
+            batch = next;
+        }
+        for (Batch *current = reversed; current; current = current->next) {
+            result.insert(result.end(), current->elements.begin(),
+                          current->elements.end());
+        }
+        delete_batches(reversed);
+        return true;
+    }
+
+    // The result is only a snapshot if other threads push concurrently.
+    bool empty() const {
+        return head.load(std::memory_order_relaxed) == nullptr;
+    }
+};
+}
+
+#endif
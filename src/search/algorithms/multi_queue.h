@@ -0,0 +1,146 @@
+#ifndef ALGORITHMS_MULTI_QUEUE_H
+#define ALGORITHMS_MULTI_QUEUE_H
+
+#include "../utils/rng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+  MultiQueue is a relaxed priority queue that can be used by several
+  threads at once (Rihani, Sanders and Dementiev, 2015).
+
+  It consists of a number of ordinary binary heaps, each protected by its
+  own lock. Elements are pushed to a random heap. To pop an element, we
+  look at the minimum keys of num_choices random heaps and pop from the
+  heap with the smallest one. Popped elements therefore need not have the
+  globally minimal key, but their rank is small in expectation. More
+  heaps mean less contention, and more choices mean a stricter order.
+  With a single heap, the queue pops elements in exact order, breaking
+  ties in FIFO order.
+
+  The minimum key of every heap is cached in an atomic variable, so
+  choosing a heap does not take any locks.
+*/
+
+namespace multi_queue {
+template<class Value>
+class MultiQueue {
+    static const int EMPTY = std::numeric_limits<int>::max();
+
+    struct Entry {
+        int key;
+        std::uint64_t push_number;
+        Value value;
+
+        Entry(int key, std::uint64_t push_number, const Value &value)
+            : key(key), push_number(push_number), value(value) {
+        }
+
+        // Order entries for a min-heap with FIFO tie-breaking.
+        bool operator<(const Entry &other) const {
+            return key > other.key ||
+                   (key == other.key && push_number > other.push_number);
+        }
+    };
+
+    struct Heap {
+        std::mutex heap_mutex;
+        std::vector<Entry> entries;
+        std::uint64_t num_pushes;
+        std::atomic<int> min_key;
+
+        Heap()
+            : num_pushes(0),
+              min_key(EMPTY) {
+        }
+    };
+
+    std::vector<std::unique_ptr<Heap>> heaps;
+    const int num_choices;
+
+    void update_min_key(Heap &heap) {
+        heap.min_key.store(
+            heap.entries.empty() ? EMPTY : heap.entries.front().key,
+            std::memory_order_relaxed);
+    }
+
+    // Try to pop from the given heap. Return false if it is empty.
+    bool pop_from(Heap &heap, Value &value) {
+        std::lock_guard<std::mutex> lock(heap.heap_mutex);
+        if (heap.entries.empty()) {
+            return false;
+        }
+        std::pop_heap(heap.entries.begin(), heap.entries.end());
+        value = heap.entries.back().value;
+        heap.entries.pop_back();
+        update_min_key(heap);
+        return true;
+    }
+
+public:
+    MultiQueue(int num_heaps, int num_choices)
+        : num_choices(num_choices) {
+        assert(num_heaps >= 1 && num_choices >= 1);
+        for (int i = 0; i < num_heaps; ++i) {
+            heaps.push_back(std::unique_ptr<Heap>(new Heap()));
+        }
+    }
+
+    MultiQueue(const MultiQueue<Value> &) = delete;
+    MultiQueue &operator=(const MultiQueue<Value> &) = delete;
+
+    void push(int key, const Value &value, utils::RandomNumberGenerator &rng) {
+        assert(key != EMPTY);
+        Heap &heap = *heaps[rng.random(heaps.size())];
+        std::lock_guard<std::mutex> lock(heap.heap_mutex);
+        heap.entries.emplace_back(key, heap.num_pushes++, value);
+        std::push_heap(heap.entries.begin(), heap.entries.end());
+        update_min_key(heap);
+    }
+
+    /*
+      Pop an element with a small key and store it in value. Return false
+      if all heaps were found empty. Since other threads may push at the
+      same time, the queue need not be empty anymore when this returns.
+    */
+    bool pop(Value &value, utils::RandomNumberGenerator &rng) {
+        for (;;) {
+            Heap *best_heap = nullptr;
+            int best_key = EMPTY;
+            for (int i = 0; i < num_choices; ++i) {
+                Heap &heap = *heaps[rng.random(heaps.size())];
+                int key = heap.min_key.load(std::memory_order_relaxed);
+                if (key < best_key) {
+                    best_heap = &heap;
+                    best_key = key;
+                }
+            }
+            if (!best_heap) {
+                // All sampled heaps are empty, so look at all of them.
+                int start = rng.random(heaps.size());
+                for (size_t i = 0; i < heaps.size(); ++i) {
+                    Heap &heap = *heaps[(start + i) % heaps.size()];
+                    if (heap.min_key.load(std::memory_order_relaxed) != EMPTY &&
+                        pop_from(heap, value)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            // Another thread may have emptied the heap in the meantime.
+            if (pop_from(*best_heap, value)) {
+                return true;
+            }
+        }
+    }
+};
+}
+
+#endif
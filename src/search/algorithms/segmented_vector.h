@@ -143,6 +143,20 @@ public:
             push_back(entry);
         }
     }
+
+    /*
+      Deallocate the segments that are not needed for the current size.
+      pop_back and resize keep them for later reuse.
+    */
+    void shrink_to_fit() {
+        size_t num_needed_segments =
+            (the_size + SEGMENT_ELEMENTS - 1) / SEGMENT_ELEMENTS;
+        while (segments.size() > num_needed_segments) {
+            entry_allocator.deallocate(segments.back(), SEGMENT_ELEMENTS);
+            segments.pop_back();
+        }
+        segments.shrink_to_fit();
+    }
 };
 
 
@@ -265,6 +279,20 @@ public:
             push_back(entry);
         }
     }
+
+    /*
+      Deallocate the segments that are not needed for the current size.
+      pop_back and resize keep them for later reuse.
+    */
+    void shrink_to_fit() {
+        size_t num_needed_segments =
+            (the_size + arrays_per_segment - 1) / arrays_per_segment;
+        while (segments.size() > num_needed_segments) {
+            element_allocator.deallocate(segments.back(), elements_per_segment);
+            segments.pop_back();
+        }
+        segments.shrink_to_fit();
+    }
 };
 }
 
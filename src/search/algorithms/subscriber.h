@@ -76,15 +76,7 @@ class SubscriberService {
     mutable std::unordered_set<Subscriber<T> *> subscribers;
 public:
     virtual ~SubscriberService() {
-        /*
-          We have to copy the subscribers because unsubscribing erases the
-          current subscriber during the iteration.
-        */
-        std::unordered_set<Subscriber<T> *> subscribers_copy(subscribers);
-        for (Subscriber<T> *subscriber : subscribers_copy) {
-            subscriber->notify_service_destroyed(static_cast<T *>(this));
-            unsubscribe(subscriber);
-        }
+        notify_and_unsubscribe_all();
     }
 
     void subscribe(Subscriber<T> *subscriber) const {
@@ -100,6 +92,24 @@ public:
         assert(subscriber->services.find(this) != subscriber->services.end());
         subscriber->services.erase(this);
     }
+
+protected:
+    /*
+      Notify all subscribers as if this service was destroyed and
+      unsubscribe them. Services can call this when all data that the
+      subscribers associate with them becomes invalid.
+    */
+    void notify_and_unsubscribe_all() const {
+        /*
+          We have to copy the subscribers because unsubscribing erases the
+          current subscriber during the iteration.
+        */
+        std::unordered_set<Subscriber<T> *> subscribers_copy(subscribers);
+        for (Subscriber<T> *subscriber : subscribers_copy) {
+            subscriber->notify_service_destroyed(static_cast<const T *>(this));
+            unsubscribe(subscriber);
+        }
+    }
 };
 }
 #endif
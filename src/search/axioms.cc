@@ -88,6 +88,7 @@ AxiomEvaluator::AxiomEvaluator(const TaskProxy &task_proxy) {
 void AxiomEvaluator::evaluate(vector<int> &state) {
     if (!task_has_axioms)
         return;
+    lock_guard<mutex> lock(evaluate_mutex);
 
     assert(queue.empty());
     for (size_t var_id = 0; var_id < default_values.size(); ++var_id) {
@@ -5,6 +5,7 @@
 #include "task_proxy.h"
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 class AxiomEvaluator {
@@ -54,6 +55,13 @@ class AxiomEvaluator {
     */
     std::vector<const AxiomLiteral *> queue;
 
+    /*
+      All state registries of a task share the evaluator, and the search
+      engines of a parallel portfolio run on different threads, each with
+      its own registry. Therefore evaluate() is serialized.
+    */
+    std::mutex evaluate_mutex;
+
     template<typename Values, typename Accessor>
     void evaluate_aux(Values &values, const Accessor &accessor);
 public:
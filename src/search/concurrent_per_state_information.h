@@ -0,0 +1,61 @@
+#ifndef CONCURRENT_PER_STATE_INFORMATION_H
+#define CONCURRENT_PER_STATE_INFORMATION_H
+
+#include "state_registry.h"
+
+#include "algorithms/concurrent_segmented_vector.h"
+
+#include <cassert>
+#include <iostream>
+
+/*
+  ConcurrentPerStateInformation associates information with the states of
+  one thread-safe StateRegistry (see state_registry.h) and can be accessed
+  by several threads at once. Lookups never take a lock and references to
+  entries stay valid as long as the object exists.
+
+  Accessing different entries from different threads is safe. Accessing
+  the same entry from several threads requires external synchronization.
+  Parallel search algorithms usually achieve this by giving every state
+  an owner thread that is the only one to access its entries.
+
+  Unlike PerStateInformation, objects of this class are bound to a single
+  registry and do not subscribe to it, so the registry must outlive them.
+*/
+template<class Entry>
+class ConcurrentPerStateInformation {
+    const StateRegistry &registry;
+    segmented_vector::ConcurrentSegmentedVector<Entry> entries;
+
+    void check_registry(const State &state) const {
+        if (state.get_registry() != &registry) {
+            std::cerr << "Tried to access concurrent per-state information "
+                      << "with a state of another registry." << std::endl;
+            utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+        }
+    }
+public:
+    explicit ConcurrentPerStateInformation(
+        const StateRegistry &registry, const Entry &default_value = Entry())
+        : registry(registry),
+          entries(default_value) {
+        assert(registry.is_thread_safe());
+    }
+
+    ConcurrentPerStateInformation(const ConcurrentPerStateInformation<Entry> &) = delete;
+    ConcurrentPerStateInformation &operator=(
+        const ConcurrentPerStateInformation<Entry> &) = delete;
+
+    Entry &operator[](const State &state) {
+        check_registry(state);
+        return (*this)[state.get_id()];
+    }
+
+    Entry &operator[](StateID id) {
+        assert(id != StateID::no_state);
+        assert(id.value < static_cast<int>(registry.size()));
+        return entries[id.value];
+    }
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "evaluator.h"
 
+#include "evaluation_context.h"
 #include "option_parser.h"
 #include "plugin.h"
 
@@ -25,6 +26,15 @@ bool Evaluator::dead_ends_are_reliable() const {
     return true;
 }
 
+void Evaluator::compute_successor_results(
+    const State &, vector<EvaluationContext> &successor_contexts,
+    vector<EvaluationResult> &results) {
+    results.clear();
+    for (EvaluationContext &eval_context : successor_contexts) {
+        results.push_back(compute_result(eval_context));
+    }
+}
+
 void Evaluator::report_value_for_initial_state(
     const EvaluationResult &result, utils::LogProxy &log) const {
     assert(use_for_reporting_minima);
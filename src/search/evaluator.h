@@ -4,6 +4,7 @@
 #include "evaluation_result.h"
 
 #include <set>
+#include <vector>
 
 class EvaluationContext;
 class State;
@@ -80,6 +81,22 @@ public:
     virtual EvaluationResult compute_result(
         EvaluationContext &eval_context) = 0;
 
+    /*
+      compute_successor_results should compute the results for a batch
+      of evaluation contexts whose states are all successors of
+      parent_state and store them in results, in the same order as the
+      contexts. Like compute_result, it does not add the results to the
+      evaluation contexts.
+
+      The default implementation calls compute_result for each context.
+      Evaluators can override it to share work between the states of a
+      batch, e.g., per-evaluation setup of data structures.
+    */
+    virtual void compute_successor_results(
+        const State &parent_state,
+        std::vector<EvaluationContext> &successor_contexts,
+        std::vector<EvaluationResult> &results);
+
     void report_value_for_initial_state(
         const EvaluationResult &result, utils::LogProxy &log) const;
     void report_new_minimum_value(
@@ -95,6 +95,56 @@ EvaluationResult Heuristic::compute_result(EvaluationContext &eval_context) {
     return result;
 }
 
+void Heuristic::compute_heuristics_for_successors(
+    const State &, const vector<State> &successors, vector<int> &values) {
+    for (const State &state : successors) {
+        values.push_back(compute_heuristic(state));
+    }
+}
+
+void Heuristic::compute_successor_results(
+    const State &parent_state, vector<EvaluationContext> &successor_contexts,
+    vector<EvaluationResult> &results) {
+    assert(preferred_operators.empty());
+    results.assign(successor_contexts.size(), EvaluationResult());
+    batch_indices.clear();
+    batch_states.clear();
+    batch_values.clear();
+    for (size_t i = 0; i < successor_contexts.size(); ++i) {
+        EvaluationContext &eval_context = successor_contexts[i];
+        const State &state = eval_context.get_state();
+        bool is_cached = cache_evaluator_values &&
+            heuristic_cache[state].h != NO_VALUE && !heuristic_cache[state].dirty;
+        if (eval_context.get_calculate_preferred() || is_cached) {
+            results[i] = compute_result(eval_context);
+        } else {
+            batch_indices.push_back(i);
+            batch_states.push_back(state);
+        }
+    }
+    if (batch_states.empty()) {
+        return;
+    }
+
+    compute_heuristics_for_successors(parent_state, batch_states, batch_values);
+    assert(batch_values.size() == batch_states.size());
+    // Preferred operators are not reported for batch evaluations.
+    preferred_operators.clear();
+    for (size_t j = 0; j < batch_states.size(); ++j) {
+        int heuristic = batch_values[j];
+        assert(heuristic == DEAD_END || heuristic >= 0);
+        if (cache_evaluator_values) {
+            heuristic_cache[batch_states[j]] = HEntry(heuristic, false);
+        }
+        if (heuristic == DEAD_END) {
+            heuristic = EvaluationResult::INFTY;
+        }
+        EvaluationResult &result = results[batch_indices[j]];
+        result.set_count_evaluation(true);
+        result.set_evaluator_value(heuristic);
+    }
+}
+
 bool Heuristic::does_cache_estimates() const {
     return cache_evaluator_values;
 }
@@ -44,6 +44,11 @@ class Heuristic : public Evaluator {
     */
     ordered_set::OrderedSet<OperatorID> preferred_operators;
 
+    // Scratch data for compute_successor_results.
+    std::vector<int> batch_indices;
+    std::vector<State> batch_states;
+    std::vector<int> batch_values;
+
 protected:
     /*
       Cache for saving h values
@@ -63,6 +68,17 @@ protected:
 
     virtual int compute_heuristic(const State &ancestor_state) = 0;
 
+    /*
+      Compute the heuristic values of the given successors of
+      parent_state and append them to values, with the same meaning as
+      the result of compute_heuristic. Preferred operators are not
+      needed, but it is fine to mark them. The default implementation
+      calls compute_heuristic for every successor.
+    */
+    virtual void compute_heuristics_for_successors(
+        const State &parent_state, const std::vector<State> &successors,
+        std::vector<int> &values);
+
     /*
       Usage note: Marking the same operator as preferred multiple times
       is OK -- it will only appear once in the list of preferred
@@ -85,6 +101,16 @@ public:
     virtual EvaluationResult compute_result(
         EvaluationContext &eval_context) override;
 
+    /*
+      Contexts that ask for preferred operators or whose estimate is
+      cached are handled by compute_result. All other states are passed
+      to compute_heuristics_for_successors in one batch.
+    */
+    virtual void compute_successor_results(
+        const State &parent_state,
+        std::vector<EvaluationContext> &successor_contexts,
+        std::vector<EvaluationResult> &results) override;
+
     virtual bool does_cache_estimates() const override;
     virtual bool is_estimate_cached(const State &state) const override;
     virtual int get_cached_estimate(const State &state) const override;
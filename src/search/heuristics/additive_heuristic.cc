@@ -19,6 +19,11 @@ AdditiveHeuristic::AdditiveHeuristic(const Options &opts)
     : RelaxationHeuristic(opts),
       did_write_overflow_warning(false) {
     utils::g_log << "Initializing additive heuristic..." << endl;
+    for (const UnaryOperator &op : unary_operators) {
+        if (op.num_preconditions == 0) {
+            precondition_free_operators.push_back(get_op_id(op));
+        }
+    }
 }
 
 void AdditiveHeuristic::write_overflow_warning() {
@@ -36,6 +41,8 @@ void AdditiveHeuristic::write_overflow_warning() {
 // heuristic computation
 void AdditiveHeuristic::setup_exploration_queue() {
     queue.clear();
+    touched_propositions.clear();
+    touched_operators.clear();
 
     for (Proposition &prop : propositions) {
         prop.cost = -1;
@@ -52,6 +59,32 @@ void AdditiveHeuristic::setup_exploration_queue() {
     }
 }
 
+/*
+  Bring the exploration data into the state that setup_exploration_queue
+  produces, assuming that this state was reached before and only the
+  touched propositions and operators changed since then.
+*/
+void AdditiveHeuristic::reset_touched_exploration_data() {
+    queue.clear();
+    for (PropID prop_id : touched_propositions) {
+        Proposition *prop = get_proposition(prop_id);
+        prop->cost = -1;
+        prop->marked = false;
+    }
+    touched_propositions.clear();
+    for (OpID op_id : touched_operators) {
+        UnaryOperator *op = get_operator(op_id);
+        op->unsatisfied_preconditions = op->num_preconditions;
+        op->cost = op->base_cost;
+    }
+    touched_operators.clear();
+
+    for (OpID op_id : precondition_free_operators) {
+        const UnaryOperator *op = get_operator(op_id);
+        enqueue_if_necessary(op->effect, op->base_cost, op_id);
+    }
+}
+
 void AdditiveHeuristic::setup_exploration_queue_state(const State &state) {
     for (FactProxy fact : state) {
         PropID init_prop = get_prop_id(fact);
@@ -76,6 +109,10 @@ void AdditiveHeuristic::relaxed_exploration() {
         for (OpID op_id : precondition_of_pool.get_slice(
                  prop->precondition_of, prop->num_precondition_occurences)) {
             UnaryOperator *unary_op = get_operator(op_id);
+            if (unary_op->unsatisfied_preconditions ==
+                unary_op->num_preconditions) {
+                touched_operators.push_back(op_id);
+            }
             increase_cost(unary_op->cost, prop_cost);
             --unary_op->unsatisfied_preconditions;
             assert(unary_op->unsatisfied_preconditions >= 0);
@@ -112,8 +149,13 @@ void AdditiveHeuristic::mark_preferred_operators(
     }
 }
 
-int AdditiveHeuristic::compute_add_and_ff(const State &state) {
-    setup_exploration_queue();
+int AdditiveHeuristic::compute_add_and_ff(
+    const State &state, bool reset_touched_only) {
+    if (reset_touched_only) {
+        reset_touched_exploration_data();
+    } else {
+        setup_exploration_queue();
+    }
     setup_exploration_queue_state(state);
     relaxed_exploration();
 
@@ -138,6 +180,14 @@ int AdditiveHeuristic::compute_heuristic(const State &ancestor_state) {
     return h;
 }
 
+void AdditiveHeuristic::compute_heuristics_for_successors(
+    const State &, const vector<State> &successors, vector<int> &values) {
+    for (size_t i = 0; i < successors.size(); ++i) {
+        State state = convert_ancestor_state(successors[i]);
+        values.push_back(compute_add_and_ff(state, i > 0));
+    }
+}
+
 void AdditiveHeuristic::compute_heuristic_for_cegar(const State &state) {
     compute_heuristic(state);
 }
@@ -7,6 +7,7 @@
 #include "../utils/collections.h"
 
 #include <cassert>
+#include <vector>
 
 class State;
 
@@ -32,7 +33,18 @@ class AdditiveHeuristic : public relaxation_heuristic::RelaxationHeuristic {
     priority_queues::AdaptiveQueue<PropID> queue;
     bool did_write_overflow_warning;
 
+    /*
+      Propositions and unary operators whose exploration data changed
+      since the last call to setup_exploration_queue. Resetting only
+      these is much cheaper than resetting all of them when the
+      exploration stops early because all goals have been reached.
+    */
+    std::vector<PropID> touched_propositions;
+    std::vector<OpID> touched_operators;
+    std::vector<OpID> precondition_free_operators;
+
     void setup_exploration_queue();
+    void reset_touched_exploration_data();
     void setup_exploration_queue_state(const State &state);
     void relaxed_exploration();
     void mark_preferred_operators(const State &state, PropID goal_id);
@@ -41,6 +53,9 @@ class AdditiveHeuristic : public relaxation_heuristic::RelaxationHeuristic {
         assert(cost >= 0);
         Proposition *prop = get_proposition(prop_id);
         if (prop->cost == -1 || prop->cost > cost) {
+            if (prop->cost == -1) {
+                touched_propositions.push_back(prop_id);
+            }
             prop->cost = cost;
             prop->reached_by = op_id;
             queue.push(cost, prop_id);
@@ -62,8 +77,18 @@ class AdditiveHeuristic : public relaxation_heuristic::RelaxationHeuristic {
 protected:
     virtual int compute_heuristic(const State &ancestor_state) override;
 
-    // Common part of h^add and h^ff computation.
-    int compute_add_and_ff(const State &state);
+    /*
+      Common part of h^add and h^ff computation. With
+      reset_touched_only, only the exploration data touched since the
+      last full setup is reset. This is only correct if the exploration
+      data has been set up completely before, which we use when
+      evaluating a batch of states.
+    */
+    int compute_add_and_ff(const State &state, bool reset_touched_only = false);
+
+    virtual void compute_heuristics_for_successors(
+        const State &parent_state, const std::vector<State> &successors,
+        std::vector<int> &values) override;
 public:
     explicit AdditiveHeuristic(const options::Options &opts);
 
@@ -37,7 +37,10 @@ void FFHeuristic::mark_preferred_operators_and_relaxed_plan(
             int operator_no = unary_op->operator_no;
             if (operator_no != -1) {
                 // This is not an axiom.
-                relaxed_plan[operator_no] = true;
+                if (!relaxed_plan[operator_no]) {
+                    relaxed_plan[operator_no] = true;
+                    relaxed_plan_operators.push_back(operator_no);
+                }
                 if (is_preferred) {
                     OperatorProxy op = task_proxy.get_operators()[operator_no];
                     assert(task_properties::is_applicable(op, state));
@@ -48,24 +51,39 @@ void FFHeuristic::mark_preferred_operators_and_relaxed_plan(
     }
 }
 
+int FFHeuristic::compute_relaxed_plan_cost(const State &state) {
+    // Collecting the relaxed plan also sets the preferred operators.
+    for (PropID goal_id : goal_propositions)
+        mark_preferred_operators_and_relaxed_plan(state, goal_id);
+
+    int h_ff = 0;
+    for (int op_no : relaxed_plan_operators) {
+        relaxed_plan[op_no] = false; // Clean up for next computation.
+        h_ff += task_proxy.get_operators()[op_no].get_cost();
+    }
+    relaxed_plan_operators.clear();
+    return h_ff;
+}
+
 int FFHeuristic::compute_heuristic(const State &ancestor_state) {
     State state = convert_ancestor_state(ancestor_state);
     int h_add = compute_add_and_ff(state);
     if (h_add == DEAD_END)
         return h_add;
+    return compute_relaxed_plan_cost(state);
+}
 
-    // Collecting the relaxed plan also sets the preferred operators.
-    for (PropID goal_id : goal_propositions)
-        mark_preferred_operators_and_relaxed_plan(state, goal_id);
-
-    int h_ff = 0;
-    for (size_t op_no = 0; op_no < relaxed_plan.size(); ++op_no) {
-        if (relaxed_plan[op_no]) {
-            relaxed_plan[op_no] = false; // Clean up for next computation.
-            h_ff += task_proxy.get_operators()[op_no].get_cost();
+void FFHeuristic::compute_heuristics_for_successors(
+    const State &, const vector<State> &successors, vector<int> &values) {
+    for (size_t i = 0; i < successors.size(); ++i) {
+        State state = convert_ancestor_state(successors[i]);
+        int h_add = compute_add_and_ff(state, i > 0);
+        if (h_add == DEAD_END) {
+            values.push_back(DEAD_END);
+        } else {
+            values.push_back(compute_relaxed_plan_cost(state));
         }
     }
-    return h_ff;
 }
 
 
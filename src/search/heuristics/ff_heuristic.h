@@ -27,10 +27,16 @@ class FFHeuristic : public additive_heuristic::AdditiveHeuristic {
     // as a bit vector.
     using RelaxedPlan = std::vector<bool>;
     RelaxedPlan relaxed_plan;
+    // Operators in the relaxed plan, so we need not scan the bit vector.
+    std::vector<int> relaxed_plan_operators;
     void mark_preferred_operators_and_relaxed_plan(
         const State &state, PropID goal_id);
+    int compute_relaxed_plan_cost(const State &state);
 protected:
     virtual int compute_heuristic(const State &ancestor_state) override;
+    virtual void compute_heuristics_for_successors(
+        const State &parent_state, const std::vector<State> &successors,
+        std::vector<int> &values) override;
 public:
     explicit FFHeuristic(const options::Options &opts);
 };
@@ -8,17 +8,65 @@
 #include "../utils/memory.h"
 
 #include <cassert>
-#include <deque>
 #include <map>
+#include <vector>
 
 using namespace std;
 
 namespace standard_scalar_open_list {
+/*
+  FIFO queue of entries stored in a single vector. Removed entries are
+  skipped by advancing the head and their space is reclaimed when the
+  bucket runs empty or when more than half of the vector is unused.
+  Unlike deque, an empty bucket does not allocate any memory, so we can
+  afford one bucket for every small key.
+*/
 template<class Entry>
-class BestFirstOpenList : public OpenList<Entry> {
-    typedef deque<Entry> Bucket;
+class Bucket {
+    vector<Entry> entries;
+    size_t head;
+public:
+    Bucket() : head(0) {
+    }
+
+    bool empty() const {
+        return head == entries.size();
+    }
+
+    void push_back(const Entry &entry) {
+        if (head > 0 && entries.size() == entries.capacity() &&
+            2 * head >= entries.size()) {
+            entries.erase(entries.begin(), entries.begin() + head);
+            head = 0;
+        }
+        entries.push_back(entry);
+    }
+
+    Entry pop_front() {
+        assert(!empty());
+        Entry result = entries[head++];
+        if (empty()) {
+            entries.clear();
+            head = 0;
+        }
+        return result;
+    }
+};
 
-    map<int, Bucket> buckets;
+template<class Entry>
+class BestFirstOpenList : public OpenList<Entry> {
+    /*
+      Keys in [0, MAX_DENSE_KEY) index the vector dense_buckets, which
+      grows up to the largest such key seen so far. All other keys
+      (negative or large values) are kept in the map sparse_buckets.
+    */
+    static const int MAX_DENSE_KEY = 1 << 16;
+
+    vector<Bucket<Entry>> dense_buckets;
+    // All dense buckets with a smaller key are empty (if there are entries).
+    int min_dense_key;
+    int num_dense_entries;
+    map<int, Bucket<Entry>> sparse_buckets;
     int size;
 
     shared_ptr<Evaluator> evaluator;
@@ -46,6 +94,8 @@ public:
 template<class Entry>
 BestFirstOpenList<Entry>::BestFirstOpenList(const Options &opts)
     : OpenList<Entry>(opts.get<bool>("pref_only")),
+      min_dense_key(0),
+      num_dense_entries(0),
       size(0),
       evaluator(opts.get<shared_ptr<Evaluator>>("eval")) {
 }
@@ -54,6 +104,8 @@ template<class Entry>
 BestFirstOpenList<Entry>::BestFirstOpenList(
     const shared_ptr<Evaluator> &evaluator, bool preferred_only)
     : OpenList<Entry>(preferred_only),
+      min_dense_key(0),
+      num_dense_entries(0),
       size(0),
       evaluator(evaluator) {
 }
@@ -62,22 +114,38 @@ template<class Entry>
 void BestFirstOpenList<Entry>::do_insertion(
     EvaluationContext &eval_context, const Entry &entry) {
     int key = eval_context.get_evaluator_value(evaluator.get());
-    buckets[key].push_back(entry);
+    if (key >= 0 && key < MAX_DENSE_KEY) {
+        if (key >= static_cast<int>(dense_buckets.size()))
+            dense_buckets.resize(key + 1);
+        dense_buckets[key].push_back(entry);
+        if (num_dense_entries == 0 || key < min_dense_key)
+            min_dense_key = key;
+        ++num_dense_entries;
+    } else {
+        sparse_buckets[key].push_back(entry);
+    }
     ++size;
 }
 
 template<class Entry>
 Entry BestFirstOpenList<Entry>::remove_min() {
     assert(size > 0);
-    auto it = buckets.begin();
-    assert(it != buckets.end());
-    Bucket &bucket = it->second;
-    assert(!bucket.empty());
-    Entry result = bucket.front();
-    bucket.pop_front();
-    if (bucket.empty())
-        buckets.erase(it);
     --size;
+    if (num_dense_entries > 0) {
+        while (dense_buckets[min_dense_key].empty())
+            ++min_dense_key;
+        // Sparse keys are either negative or larger than all dense keys.
+        if (sparse_buckets.empty() || sparse_buckets.begin()->first > 0) {
+            --num_dense_entries;
+            return dense_buckets[min_dense_key].pop_front();
+        }
+    }
+    auto it = sparse_buckets.begin();
+    assert(it != sparse_buckets.end());
+    Bucket<Entry> &bucket = it->second;
+    Entry result = bucket.pop_front();
+    if (bucket.empty())
+        sparse_buckets.erase(it);
     return result;
 }
 
@@ -88,7 +156,10 @@ bool BestFirstOpenList<Entry>::empty() const {
 
 template<class Entry>
 void BestFirstOpenList<Entry>::clear() {
-    buckets.clear();
+    vector<Bucket<Entry>>().swap(dense_buckets);
+    min_dense_key = 0;
+    num_dense_entries = 0;
+    sparse_buckets.clear();
     size = 0;
 }
 
@@ -131,11 +202,16 @@ static shared_ptr<OpenListFactory> _parse(OptionParser &parser) {
         "Open list that uses a single evaluator and FIFO tiebreaking.");
     parser.document_note(
         "Implementation Notes",
-        "Elements with the same evaluator value are stored in double-ended "
-        "queues, called \"buckets\". The open list stores a map from evaluator "
-        "values to buckets. Pushing and popping from a bucket runs in constant "
-        "time. Therefore, inserting and removing an entry from the open list "
-        "takes time O(log(n)), where n is the number of buckets.");
+        "Elements with the same evaluator value are stored in FIFO queues, "
+        "called \"buckets\". Pushing and popping from a bucket runs in "
+        "amortized constant time. For evaluator values between 0 and 65535, "
+        "the open list stores a vector of buckets indexed by the value and "
+        "remembers the smallest value that may have a non-empty bucket. "
+        "Inserting an entry then takes constant time and removing an entry "
+        "takes time linear in the distance between the removed value and "
+        "the previously removed value. Buckets for all other values are "
+        "stored in a map, for which inserting and removing an entry takes "
+        "time O(log(n)), where n is the number of such buckets.");
     parser.add_option<shared_ptr<Evaluator>>("eval", "evaluator");
     parser.add_option<bool>(
         "pref_only",
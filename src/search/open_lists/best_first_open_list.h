@@ -8,7 +8,8 @@
 /*
   Open list indexed by a single int, using FIFO tie-breaking.
 
-  Implemented as a map from int to deques.
+  Implemented as a vector of buckets for small non-negative keys and a
+  map from int to buckets for all other keys.
 */
 
 namespace standard_scalar_open_list {
@@ -5,8 +5,10 @@
 #include "../option_parser.h"
 #include "../plugin.h"
 
+#include "../utils/language.h"
 #include "../utils/memory.h"
 
+#include <array>
 #include <cassert>
 #include <deque>
 #include <map>
@@ -16,11 +18,38 @@
 using namespace std;
 
 namespace tiebreaking_open_list {
-template<class Entry>
+/*
+  Keys of open lists with at most MAX_FLAT_KEY_SIZE evaluators are stored
+  inline in a fixed-size array padded with zeros. Such keys compare like
+  the corresponding vectors, but creating and comparing them does not
+  need any heap allocations or indirections.
+*/
+static const size_t MAX_FLAT_KEY_SIZE = 4;
+using FlatKey = array<int, MAX_FLAT_KEY_SIZE>;
+
+static void init_key(vector<int> &key, size_t dimension) {
+    key.reserve(dimension);
+}
+
+static void init_key(FlatKey &key, size_t dimension) {
+    assert(dimension <= MAX_FLAT_KEY_SIZE);
+    utils::unused_variable(dimension);
+    key.fill(0);
+}
+
+static void set_key_value(vector<int> &key, size_t /*index*/, int value) {
+    key.push_back(value);
+}
+
+static void set_key_value(FlatKey &key, size_t index, int value) {
+    key[index] = value;
+}
+
+template<class Entry, class Key>
 class TieBreakingOpenList : public OpenList<Entry> {
     using Bucket = deque<Entry>;
 
-    map<const vector<int>, Bucket> buckets;
+    map<Key, Bucket> buckets;
     int size;
 
     vector<shared_ptr<Evaluator>> evaluators;
@@ -52,29 +81,30 @@ public:
 };
 
 
-template<class Entry>
-TieBreakingOpenList<Entry>::TieBreakingOpenList(const Options &opts)
+template<class Entry, class Key>
+TieBreakingOpenList<Entry, Key>::TieBreakingOpenList(const Options &opts)
     : OpenList<Entry>(opts.get<bool>("pref_only")),
       size(0), evaluators(opts.get_list<shared_ptr<Evaluator>>("evals")),
       allow_unsafe_pruning(opts.get<bool>("unsafe_pruning")) {
 }
 
-template<class Entry>
-void TieBreakingOpenList<Entry>::do_insertion(
+template<class Entry, class Key>
+void TieBreakingOpenList<Entry, Key>::do_insertion(
     EvaluationContext &eval_context, const Entry &entry) {
-    vector<int> key;
-    key.reserve(evaluators.size());
-    for (const shared_ptr<Evaluator> &evaluator : evaluators)
-        key.push_back(eval_context.get_evaluator_value_or_infinity(evaluator.get()));
+    Key key;
+    init_key(key, evaluators.size());
+    for (size_t i = 0; i < evaluators.size(); ++i)
+        set_key_value(key, i, eval_context.get_evaluator_value_or_infinity(
+                          evaluators[i].get()));
 
     buckets[key].push_back(entry);
     ++size;
 }
 
-template<class Entry>
-Entry TieBreakingOpenList<Entry>::remove_min() {
+template<class Entry, class Key>
+Entry TieBreakingOpenList<Entry, Key>::remove_min() {
     assert(size > 0);
-    typename map<const vector<int>, Bucket>::iterator it;
+    typename map<Key, Bucket>::iterator it;
     it = buckets.begin();
     assert(it != buckets.end());
     assert(!it->second.empty());
@@ -86,31 +116,31 @@ Entry TieBreakingOpenList<Entry>::remove_min() {
     return result;
 }
 
-template<class Entry>
-bool TieBreakingOpenList<Entry>::empty() const {
+template<class Entry, class Key>
+bool TieBreakingOpenList<Entry, Key>::empty() const {
     return size == 0;
 }
 
-template<class Entry>
-void TieBreakingOpenList<Entry>::clear() {
+template<class Entry, class Key>
+void TieBreakingOpenList<Entry, Key>::clear() {
     buckets.clear();
     size = 0;
 }
 
-template<class Entry>
-int TieBreakingOpenList<Entry>::dimension() const {
+template<class Entry, class Key>
+int TieBreakingOpenList<Entry, Key>::dimension() const {
     return evaluators.size();
 }
 
-template<class Entry>
-void TieBreakingOpenList<Entry>::get_path_dependent_evaluators(
+template<class Entry, class Key>
+void TieBreakingOpenList<Entry, Key>::get_path_dependent_evaluators(
     set<Evaluator *> &evals) {
     for (const shared_ptr<Evaluator> &evaluator : evaluators)
         evaluator->get_path_dependent_evaluators(evals);
 }
 
-template<class Entry>
-bool TieBreakingOpenList<Entry>::is_dead_end(
+template<class Entry, class Key>
+bool TieBreakingOpenList<Entry, Key>::is_dead_end(
     EvaluationContext &eval_context) const {
     // TODO: Properly document this behaviour.
     // If one safe heuristic detects a dead end, return true.
@@ -128,8 +158,8 @@ bool TieBreakingOpenList<Entry>::is_dead_end(
     return true;
 }
 
-template<class Entry>
-bool TieBreakingOpenList<Entry>::is_reliable_dead_end(
+template<class Entry, class Key>
+bool TieBreakingOpenList<Entry, Key>::is_reliable_dead_end(
     EvaluationContext &eval_context) const {
     for (const shared_ptr<Evaluator> &evaluator : evaluators)
         if (eval_context.is_evaluator_value_infinite(evaluator.get()) &&
@@ -142,18 +172,35 @@ TieBreakingOpenListFactory::TieBreakingOpenListFactory(const Options &options)
     : options(options) {
 }
 
+template<class Entry>
+static unique_ptr<OpenList<Entry>> create_tiebreaking_open_list(
+    const Options &options) {
+    size_t dimension = options.get_list<shared_ptr<Evaluator>>("evals").size();
+    if (dimension <= MAX_FLAT_KEY_SIZE) {
+        return utils::make_unique_ptr<TieBreakingOpenList<Entry, FlatKey>>(options);
+    } else {
+        return utils::make_unique_ptr<TieBreakingOpenList<Entry, vector<int>>>(options);
+    }
+}
+
 unique_ptr<StateOpenList>
 TieBreakingOpenListFactory::create_state_open_list() {
-    return utils::make_unique_ptr<TieBreakingOpenList<StateOpenListEntry>>(options);
+    return create_tiebreaking_open_list<StateOpenListEntry>(options);
 }
 
 unique_ptr<EdgeOpenList>
 TieBreakingOpenListFactory::create_edge_open_list() {
-    return utils::make_unique_ptr<TieBreakingOpenList<EdgeOpenListEntry>>(options);
+    return create_tiebreaking_open_list<EdgeOpenListEntry>(options);
 }
 
 static shared_ptr<OpenListFactory> _parse(OptionParser &parser) {
     parser.document_synopsis("Tie-breaking open list", "");
+    parser.document_note(
+        "Implementation Notes",
+        "Elements with the same evaluator values are stored in double-ended "
+        "queues, called \"buckets\". The open list stores a map from the "
+        "tuples of evaluator values to buckets. For up to four evaluators, "
+        "the tuples are stored inline as fixed-size arrays.");
     parser.add_list_option<shared_ptr<Evaluator>>("evals", "evaluators");
     parser.add_option<bool>(
         "pref_only",
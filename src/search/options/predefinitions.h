@@ -30,6 +30,14 @@ public:
         return predefined.find(key) != predefined.end();
     }
 
+    // Return true if the key is predefined with an object of type T.
+    template<typename T>
+    bool contains_type(const std::string &key) const {
+        auto it = predefined.find(key);
+        return it != predefined.end() &&
+               it->second.first == std::type_index(typeid(T));
+    }
+
     template<typename T>
     T get(const std::string &key) const {
         try {
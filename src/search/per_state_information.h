@@ -6,6 +6,8 @@
 #include "algorithms/segmented_vector.h"
 #include "algorithms/subscriber.h"
 #include "utils/collections.h"
+#include "utils/language.h"
+#include "utils/mapped_file_pool.h"
 
 #include <cassert>
 #include <iostream>
@@ -31,6 +33,18 @@
   remember (in "cached_registry" and "cached_entries") the results of the
   previous lookup and reuse it on consecutive lookups for the same registry.
 
+  Most searches only ever use one registry. A PerStateInformation object
+  that is constructed for a given registry stores the SegmentedVector for
+  this registry separately and checks it first, so lookups for states of
+  this registry only compare the registry pointer and index the vector.
+  Lookups for other registries still work as described above. In both
+  cases, the vector for a registry only grows (to the current size of
+  the registry) when a state beyond its end is accessed.
+
+  If a StateRegistry stores its state data in a memory-mapped file (see
+  state_registry.h), the SegmentedVector for this registry allocates its
+  segments in the same file.
+
   A PerStateInformation object subscribes to every StateRegistry for which it
   stores information. Once a StateRegistry is destroyed, it notifies all
   subscribed objects, which in turn destroy all information stored for states
@@ -39,12 +53,49 @@
 template<class Entry>
 class PerStateInformation : public subscriber::Subscriber<StateRegistry> {
     const Entry default_value;
-    using EntryVectorMap = std::unordered_map<const StateRegistry *,
-                                              segmented_vector::SegmentedVector<Entry> * >;
+    using EntryVector = segmented_vector::SegmentedVector<
+        Entry, utils::MappedFileAllocator<Entry>>;
+    using EntryVectorMap = std::unordered_map<const StateRegistry *, EntryVector *>;
     EntryVectorMap entries_by_registry;
 
     mutable const StateRegistry *cached_registry;
-    mutable segmented_vector::SegmentedVector<Entry> *cached_entries;
+    mutable EntryVector *cached_entries;
+
+    // Registry given on construction and its entries; nullptr otherwise.
+    const StateRegistry *bound_registry;
+    EntryVector *bound_entries;
+
+    EntryVector *create_entries(const StateRegistry *registry) {
+        EntryVector *entries = new EntryVector(
+            utils::MappedFileAllocator<Entry>(registry->get_mapped_file_pool()));
+        entries_by_registry[registry] = entries;
+        registry->subscribe(this);
+        return entries;
+    }
+
+    Entry &get_entry(EntryVector &entries, const StateRegistry &registry,
+                     const State &state) {
+        int state_id = state.get_id().value;
+        assert(state.get_id() != StateID::no_state);
+        assert(utils::in_bounds(state_id, registry));
+        if (static_cast<size_t>(state_id) >= entries.size()) {
+            entries.resize(registry.size(), default_value);
+        }
+        return entries[state_id];
+    }
+
+    const Entry &get_entry(const EntryVector &entries, const StateRegistry &registry,
+                           const State &state) const {
+        utils::unused_variable(registry);
+        int state_id = state.get_id().value;
+        assert(state.get_id() != StateID::no_state);
+        assert(utils::in_bounds(state_id, registry));
+        int num_entries = entries.size();
+        if (state_id >= num_entries) {
+            return default_value;
+        }
+        return entries[state_id];
+    }
 
     /*
       Returns the SegmentedVector associated with the given StateRegistry.
@@ -52,14 +103,12 @@ class PerStateInformation : public subscriber::Subscriber<StateRegistry> {
       Both the registry and the returned vector are cached to speed up
       consecutive calls with the same registry.
     */
-    segmented_vector::SegmentedVector<Entry> *get_entries(const StateRegistry *registry) {
+    EntryVector *get_entries(const StateRegistry *registry) {
         if (cached_registry != registry) {
             cached_registry = registry;
             auto it = entries_by_registry.find(registry);
             if (it == entries_by_registry.end()) {
-                cached_entries = new segmented_vector::SegmentedVector<Entry>();
-                entries_by_registry[registry] = cached_entries;
-                registry->subscribe(this);
+                cached_entries = create_entries(registry);
             } else {
                 cached_entries = it->second;
             }
@@ -74,14 +123,14 @@ class PerStateInformation : public subscriber::Subscriber<StateRegistry> {
       Otherwise, both the registry and the returned vector are cached to speed
       up consecutive calls with the same registry.
     */
-    const segmented_vector::SegmentedVector<Entry> *get_entries(const StateRegistry *registry) const {
+    const EntryVector *get_entries(const StateRegistry *registry) const {
         if (cached_registry != registry) {
             const auto it = entries_by_registry.find(registry);
             if (it == entries_by_registry.end()) {
                 return nullptr;
             } else {
                 cached_registry = registry;
-                cached_entries = const_cast<segmented_vector::SegmentedVector<Entry> *>(it->second);
+                cached_entries = const_cast<EntryVector *>(it->second);
             }
         }
         assert(cached_registry == registry);
@@ -92,13 +141,27 @@ public:
     PerStateInformation()
         : default_value(),
           cached_registry(nullptr),
-          cached_entries(nullptr) {
+          cached_entries(nullptr),
+          bound_registry(nullptr),
+          bound_entries(nullptr) {
     }
 
     explicit PerStateInformation(const Entry &default_value_)
         : default_value(default_value_),
           cached_registry(nullptr),
-          cached_entries(nullptr) {
+          cached_entries(nullptr),
+          bound_registry(nullptr),
+          bound_entries(nullptr) {
+    }
+
+    // Optimize lookups for states of the given registry (see above).
+    explicit PerStateInformation(const StateRegistry &registry,
+                                 const Entry &default_value_ = Entry())
+        : default_value(default_value_),
+          cached_registry(nullptr),
+          cached_entries(nullptr),
+          bound_registry(&registry),
+          bound_entries(create_entries(&registry)) {
     }
 
     PerStateInformation(const PerStateInformation<Entry> &) = delete;
@@ -112,41 +175,32 @@ public:
 
     Entry &operator[](const State &state) {
         const StateRegistry *registry = state.get_registry();
+        if (bound_registry && registry == bound_registry) {
+            return get_entry(*bound_entries, *registry, state);
+        }
         if (!registry) {
             std::cerr << "Tried to access per-state information with an "
                       << "unregistered state." << std::endl;
             utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
         }
-        segmented_vector::SegmentedVector<Entry> *entries = get_entries(registry);
-        int state_id = state.get_id().value;
-        assert(state.get_id() != StateID::no_state);
-        size_t virtual_size = registry->size();
-        assert(utils::in_bounds(state_id, *registry));
-        if (entries->size() < virtual_size) {
-            entries->resize(virtual_size, default_value);
-        }
-        return (*entries)[state_id];
+        return get_entry(*get_entries(registry), *registry, state);
     }
 
     const Entry &operator[](const State &state) const {
         const StateRegistry *registry = state.get_registry();
+        if (bound_registry && registry == bound_registry) {
+            return get_entry(*bound_entries, *registry, state);
+        }
         if (!registry) {
             std::cerr << "Tried to access per-state information with an "
                       << "unregistered state." << std::endl;
             utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
         }
-        const segmented_vector::SegmentedVector<Entry> *entries = get_entries(registry);
+        const EntryVector *entries = get_entries(registry);
         if (!entries) {
             return default_value;
         }
-        int state_id = state.get_id().value;
-        assert(state.get_id() != StateID::no_state);
-        assert(utils::in_bounds(state_id, *registry));
-        int num_entries = entries->size();
-        if (state_id >= num_entries) {
-            return default_value;
-        }
-        return (*entries)[state_id];
+        return get_entry(*entries, *registry, state);
     }
 
     virtual void notify_service_destroyed(const StateRegistry *registry) override {
@@ -156,6 +210,10 @@ public:
             cached_registry = nullptr;
             cached_entries = nullptr;
         }
+        if (registry == bound_registry) {
+            bound_registry = nullptr;
+            bound_entries = nullptr;
+        }
     }
 };
 
@@ -10,6 +10,7 @@
 #include "task_utils/task_properties.h"
 #include "tasks/root_task.h"
 #include "utils/countdown_timer.h"
+#include "utils/mapped_file_pool.h"
 #include "utils/rng_options.h"
 #include "utils/system.h"
 #include "utils/timer.h"
@@ -41,20 +42,35 @@ successor_generator::SuccessorGenerator &get_successor_generator(
     return successor_generator;
 }
 
+static shared_ptr<utils::MappedFilePool> create_mapped_file_pool(
+    const Options &opts) {
+    if (!opts.contains("state_pool_directory")) {
+        return nullptr;
+    }
+    size_t max_size_in_bytes =
+        static_cast<size_t>(opts.get<int>("state_pool_size")) * 1024 * 1024;
+    return make_shared<utils::MappedFilePool>(
+        opts.get<string>("state_pool_directory"), max_size_in_bytes);
+}
+
 SearchEngine::SearchEngine(const Options &opts)
     : status(IN_PROGRESS),
       solution_found(false),
       task(tasks::g_root_task),
       task_proxy(*task),
       log(utils::get_log_from_options(opts)),
-      state_registry(task_proxy),
+      state_registry(task_proxy, false, opts.get<bool>("zobrist_hashing"),
+                     opts.get<bool>("compress_states"),
+                     create_mapped_file_pool(opts)),
       successor_generator(get_successor_generator(task_proxy, log)),
-      search_space(state_registry, log),
+      search_space(state_registry, log, opts.get<bool>("store_parents"),
+                   opts.get<OperatorCost>("cost_type")),
       search_progress(log),
       statistics(log),
       cost_type(opts.get<OperatorCost>("cost_type")),
       is_unit_cost(task_properties::is_unit_cost(task_proxy)),
-      max_time(opts.get<double>("max_time")) {
+      max_time(opts.get<double>("max_time")),
+      stop_requested(false) {
     if (opts.get<int>("bound") < 0) {
         cerr << "error: negative cost bound " << opts.get<int>("bound") << endl;
         utils::exit_with(ExitCode::SEARCH_INPUT_ERROR);
@@ -94,6 +110,10 @@ void SearchEngine::search() {
             status = TIMEOUT;
             break;
         }
+        if (status == IN_PROGRESS && stop_requested) {
+            log << "Stop requested. Abort search." << endl;
+            status = TIMEOUT;
+        }
     }
     // TODO: Revise when and which search times are logged.
     log << "Actual search time: " << timer.get_elapsed_time() << endl;
@@ -149,6 +169,49 @@ void SearchEngine::add_options_to_parser(OptionParser &parser) {
         "experiments. Timed-out searches are treated as failed searches, "
         "just like incomplete search algorithms that exhaust their search space.",
         "infinity");
+    parser.add_option<bool>(
+        "zobrist_hashing",
+        "store a Zobrist hash with every registered state and compute the "
+        "hashes of successor states incrementally from the changed variables "
+        "instead of hashing the complete state data for every lookup. This "
+        "speeds up duplicate detection for tasks with large states at the cost "
+        "of one additional bin of packed state data per state.",
+        "false");
+    parser.add_option<bool>(
+        "compress_states",
+        "store the data of states that were not registered recently in "
+        "compressed form. This usually allows storing several times more "
+        "states at the cost of decompressing states when they are looked up "
+        "again (e.g., when they are expanded).",
+        "false");
+    parser.add_option<bool>(
+        "store_parents",
+        "store the parent state and creating operator of every search node. "
+        "Without them, search nodes take half the memory, and the plan is "
+        "reconstructed by regression from the goal. For every plan step, "
+        "this tries all operators and, for the variables that an operator "
+        "changes without a precondition on them, all values that are "
+        "consistent with the state and the effect conditions. This can "
+        "take time exponential in the number of such variables of an "
+        "operator.",
+        "true");
+    parser.add_option<string>(
+        "state_pool_directory",
+        "store the registered states and the per-state information of the "
+        "search (e.g., search nodes and cached heuristic values) in a "
+        "memory-mapped file in this directory, so the operating system can "
+        "move data that is not used to disk when memory runs out. The "
+        "directory should be on a fast local disk. The file is removed when "
+        "the planner terminates. By default, all data is kept in memory.",
+        OptionParser::NONE);
+    parser.add_option<int>(
+        "state_pool_size",
+        "maximum size of the memory-mapped file in MiB (only used with "
+        "state_pool_directory). Disk space is reserved in chunks of 64 MiB "
+        "as the file grows. Note that the mapped file counts towards "
+        "address space limits.",
+        "infinity",
+        Bounds("1", "infinity"));
     utils::add_log_options_to_parser(parser);
 }
 
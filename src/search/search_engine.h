@@ -12,6 +12,7 @@
 
 #include "utils/logging.h"
 
+#include <atomic>
 #include <vector>
 
 namespace options {
@@ -47,10 +48,15 @@ protected:
     SearchSpace search_space;
     SearchProgress search_progress;
     SearchStatistics statistics;
-    int bound;
+    /*
+      The bound can be lowered by other threads while the search runs
+      (see set_bound), so engines should not keep copies of it.
+    */
+    std::atomic<int> bound;
     OperatorCost cost_type;
     bool is_unit_cost;
     double max_time;
+    std::atomic<bool> stop_requested;
 
     virtual void initialize() {}
     virtual SearchStatus step() = 0;
@@ -68,8 +74,17 @@ public:
     const Plan &get_plan() const;
     void search();
     const SearchStatistics &get_statistics() const {return statistics;}
+    // Can be called by other threads while the search runs.
     void set_bound(int b) {bound = b;}
     int get_bound() {return bound;}
+    /*
+      Ask the search to stop. Can be called by other threads while the
+      search runs. The search stops after the current step as if the
+      time limit was reached. Engines whose steps run for a long time
+      should also check is_stop_requested within their steps.
+    */
+    void request_stop() {stop_requested = true;}
+    bool is_stop_requested() const {return stop_requested;}
     PlanManager &get_plan_manager() {return plan_manager;}
 
     /* The following three methods should become functions as they
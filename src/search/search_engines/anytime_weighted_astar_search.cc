@@ -0,0 +1,351 @@
+#include "anytime_weighted_astar_search.h"
+
+#include "search_common.h"
+
+#include "../evaluation_context.h"
+#include "../evaluation_result.h"
+#include "../evaluator.h"
+#include "../open_list_factory.h"
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../task_utils/successor_generator.h"
+#include "../task_utils/task_properties.h"
+#include "../utils/logging.h"
+
+#include <algorithm>
+#include <cassert>
+#include <set>
+
+using namespace std;
+
+namespace anytime_weighted_astar_search {
+AnytimeWeightedAStarSearch::AnytimeWeightedAStarSearch(const Options &opts)
+    : SearchEngine(opts),
+      evaluator(opts.get<shared_ptr<Evaluator>>("eval")),
+      weights(opts.get_list<int>("weights")),
+      restart(opts.get<bool>("restart")),
+      iteration(-1),
+      num_plans(0) {
+}
+
+int AnytimeWeightedAStarSearch::get_weight() const {
+    assert(iteration >= 0);
+    return weights[min(static_cast<size_t>(iteration), weights.size() - 1)];
+}
+
+/*
+  With restarts, a node is only closed for the iteration in which it was
+  expanded.
+*/
+bool AnytimeWeightedAStarSearch::is_closed(const NodeInfo &info) const {
+    return info.closed && (!restart || info.iteration == iteration);
+}
+
+/*
+  Insert a state that has been evaluated before into the open list. The
+  stored heuristic value is passed to the open list through the
+  evaluation context, so the heuristic is not called again.
+*/
+void AnytimeWeightedAStarSearch::insert(const State &state, const NodeInfo &info) {
+    assert(info.h != NodeInfo::NOT_EVALUATED && info.h != EvaluationResult::INFTY);
+    EvaluationContext eval_context(state, info.g, false, &statistics);
+    EvaluationResult result;
+    result.set_evaluator_value(info.h);
+    result.set_count_evaluation(false);
+    eval_context.set_result(evaluator.get(), result);
+    open_list->insert(eval_context, state.get_id());
+}
+
+void AnytimeWeightedAStarSearch::start_iteration() {
+    ++iteration;
+    unique_ptr<StateOpenList> previous_open_list = move(open_list);
+    open_list = search_common::create_tiebreaking_wastar_open_list_factory(
+        evaluator, get_weight())->create_state_open_list();
+    log << "Starting iteration " << iteration + 1 << " with weight "
+        << get_weight() << ", (real) bound = " << bound << endl;
+
+    if (restart || !previous_open_list) {
+        State initial_state = state_registry.get_initial_state();
+        NodeInfo &info = search_nodes[initial_state];
+        if (info.h != EvaluationResult::INFTY) {
+            info.iteration = iteration;
+            info.closed = false;
+            insert(initial_state, info);
+        }
+    } else {
+        while (!previous_open_list->empty()) {
+            State state = state_registry.lookup_state(
+                previous_open_list->remove_min());
+            NodeInfo &info = search_nodes[state];
+            if (!info.closed && info.iteration != iteration &&
+                info.real_g < bound) {
+                info.iteration = iteration;
+                insert(state, info);
+            }
+        }
+        for (StateID id : inconsistent_states) {
+            State state = state_registry.lookup_state(id);
+            NodeInfo &info = search_nodes[state];
+            assert(info.closed && info.inconsistent);
+            info.iteration = iteration;
+            info.closed = false;
+            info.inconsistent = false;
+            insert(state, info);
+        }
+        inconsistent_states.clear();
+    }
+}
+
+void AnytimeWeightedAStarSearch::initialize() {
+    log << "Conducting anytime weighted A* search "
+        << (restart ? "with" : "without") << " restarts, weights =";
+    for (int weight : weights) {
+        log << " " << weight;
+    }
+    log << ", (real) bound = " << bound << endl;
+
+    set<Evaluator *> evals;
+    evaluator->get_path_dependent_evaluators(evals);
+    path_dependent_evaluators.assign(evals.begin(), evals.end());
+
+    State initial_state = state_registry.get_initial_state();
+    for (Evaluator *evaluator : path_dependent_evaluators) {
+        evaluator->notify_initial_state(initial_state);
+    }
+
+    EvaluationContext eval_context(initial_state, 0, false, &statistics);
+    statistics.inc_evaluated_states();
+    NodeInfo &info = search_nodes[initial_state];
+    if (eval_context.is_evaluator_value_infinite(evaluator.get())) {
+        log << "Initial state is a dead end." << endl;
+        info.h = EvaluationResult::INFTY;
+    } else {
+        info.h = eval_context.get_evaluator_value(evaluator.get());
+        info.g = 0;
+        info.real_g = 0;
+    }
+    print_initial_evaluator_values(eval_context, log);
+
+    start_iteration();
+}
+
+bool AnytimeWeightedAStarSearch::report_plan(const State &goal_state) {
+    Plan plan;
+    StateID current_id = goal_state.get_id();
+    for (;;) {
+        const NodeInfo &info =
+            search_nodes[state_registry.lookup_state(current_id)];
+        if (info.creating_operator == OperatorID::no_operator) {
+            assert(info.parent_state_id == StateID::no_state);
+            break;
+        }
+        plan.push_back(info.creating_operator);
+        current_id = info.parent_state_id;
+    }
+    reverse(plan.begin(), plan.end());
+
+    /*
+      Parent pointers only change to paths with lower (adjusted) g values.
+      With adjusted costs, such a path can be more expensive in real costs,
+      so the plan can cost more than the real g value of the goal state
+      and need not be below the bound.
+    */
+    int plan_cost = calculate_plan_cost(plan, task_proxy);
+    if (plan_cost >= bound) {
+        log << "Ignoring plan with cost " << plan_cost
+            << " that is not below the bound" << endl;
+        return false;
+    }
+    ++num_plans;
+    log << "Solution found with cost " << plan_cost << " in iteration "
+        << iteration + 1 << " (weight " << get_weight() << ")" << endl;
+    plan_manager.save_plan(plan, task_proxy, true);
+    set_plan(plan);
+    bound = plan_cost;
+    return true;
+}
+
+void AnytimeWeightedAStarSearch::expand(const State &state) {
+    const NodeInfo &info = search_nodes[state];
+    int g = info.g;
+    int real_g = info.real_g;
+
+    vector<OperatorID> applicable_ops;
+    successor_generator.generate_applicable_ops(state, applicable_ops);
+    statistics.inc_generated_ops(applicable_ops.size());
+    for (OperatorID op_id : applicable_ops) {
+        OperatorProxy op = task_proxy.get_operators()[op_id];
+        if (real_g + op.get_cost() >= bound)
+            continue;
+
+        State succ_state = state_registry.get_successor_state(state, op);
+        statistics.inc_generated();
+        for (Evaluator *evaluator : path_dependent_evaluators) {
+            evaluator->notify_state_transition(state, op_id, succ_state);
+        }
+
+        NodeInfo &succ_info = search_nodes[succ_state];
+        int succ_g = g + get_adjusted_cost(op);
+        if (succ_info.h == NodeInfo::NOT_EVALUATED) {
+            EvaluationContext succ_eval_context(
+                succ_state, succ_g, false, &statistics);
+            statistics.inc_evaluated_states();
+            if (succ_eval_context.is_evaluator_value_infinite(evaluator.get())) {
+                succ_info.h = EvaluationResult::INFTY;
+                statistics.inc_dead_ends();
+                continue;
+            }
+            succ_info.h = succ_eval_context.get_evaluator_value(evaluator.get());
+            succ_info.g = succ_g;
+            succ_info.real_g = real_g + op.get_cost();
+            succ_info.parent_state_id = state.get_id();
+            succ_info.creating_operator = op_id;
+            succ_info.iteration = iteration;
+            open_list->insert(succ_eval_context, succ_state.get_id());
+            continue;
+        }
+        if (succ_info.h == EvaluationResult::INFTY)
+            continue;
+
+        bool improved = succ_g < succ_info.g;
+        if (improved) {
+            succ_info.g = succ_g;
+            succ_info.real_g = real_g + op.get_cost();
+            succ_info.parent_state_id = state.get_id();
+            succ_info.creating_operator = op_id;
+        }
+        if (is_closed(succ_info)) {
+            if (!improved) {
+                continue;
+            } else if (restart) {
+                statistics.inc_reopened();
+                succ_info.closed = false;
+                insert(succ_state, succ_info);
+            } else if (!succ_info.inconsistent) {
+                succ_info.inconsistent = true;
+                inconsistent_states.push_back(succ_state.get_id());
+            }
+        } else if (succ_info.iteration == iteration) {
+            // The state is already in the open list.
+            if (improved) {
+                insert(succ_state, succ_info);
+            }
+        } else {
+            // The state was reached in an earlier iteration.
+            succ_info.iteration = iteration;
+            succ_info.closed = false;
+            insert(succ_state, succ_info);
+        }
+    }
+}
+
+SearchStatus AnytimeWeightedAStarSearch::step() {
+    while (true) {
+        if (open_list->empty()) {
+            if (!inconsistent_states.empty()) {
+                start_iteration();
+                continue;
+            }
+            if (found_solution()) {
+                log << "Completely explored state space -- "
+                    << "no solution cheaper than " << bound << "!" << endl;
+                return SOLVED;
+            }
+            log << "Completely explored state space -- no solution!" << endl;
+            return FAILED;
+        }
+        State state = state_registry.lookup_state(open_list->remove_min());
+        NodeInfo &info = search_nodes[state];
+        // Skip duplicates and states that the bound prunes by now.
+        if (is_closed(info) || info.real_g >= bound)
+            continue;
+
+        statistics.inc_expanded();
+        /*
+          Goal states stay open, so a cheaper path to a goal state that
+          is found later in the same iteration still leads to a plan.
+        */
+        if (task_properties::is_goal_state(task_proxy, state)) {
+            if (report_plan(state) &&
+                static_cast<size_t>(iteration) + 1 < weights.size()) {
+                start_iteration();
+            }
+            return IN_PROGRESS;
+        }
+        info.closed = true;
+        expand(state);
+        return IN_PROGRESS;
+    }
+}
+
+void AnytimeWeightedAStarSearch::print_statistics() const {
+    statistics.print_detailed_statistics();
+    log << "Iterations: " << iteration + 1 << endl;
+    log << "Plans found: " << num_plans << endl;
+    state_registry.print_statistics(log);
+}
+
+void AnytimeWeightedAStarSearch::save_plan_if_necessary() {
+    // Every plan is saved as soon as it is found.
+}
+
+static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Anytime weighted A* search",
+        "Weighted A* with a sequence of decreasing weights that keeps the "
+        "state registry, the search nodes and the heuristic values between "
+        "iterations. Every plan is saved as soon as it is found, and its "
+        "cost bounds all later iterations. Iterations start from the "
+        "initial state (restarting weighted A*, as in LAMA) or continue "
+        "with the open states of the previous iteration (anytime repairing "
+        "A*). After the last weight, the search continues with the lowered "
+        "bound until the state space is exhausted.");
+    parser.document_note(
+        "Comparison with iterated search",
+        "A configuration like\n```\n--evaluator \"h=ff()\" --search "
+        "\"iterated([eager_wastar([h], w=5), eager_wastar([h], w=3), "
+        "eager_wastar([h], w=2), eager_wastar([h], w=1)], "
+        "repeat_last=true)\"\n```\nbuilds a new state registry for every "
+        "iteration and therefore evaluates states again in every "
+        "iteration. With\n```\n--search \"anytime_wastar(ff(), "
+        "weights=[5,3,2,1])\"\n```\nevery state is evaluated at most once.");
+    parser.document_note(
+        "Evaluators",
+        "The heuristic value of a state is computed when the state is "
+        "reached for the first time and never recomputed, also for "
+        "path-dependent evaluators. Preferred operators are not used. "
+        "The open lists break ties between states with equal g + w * h "
+        "in favor of lower h.");
+    parser.add_option<shared_ptr<Evaluator>>("eval", "evaluator for h-value");
+    parser.add_list_option<int>(
+        "weights",
+        "weights of the iterations; the last weight is kept until the "
+        "search ends",
+        "[5,3,2,1]");
+    parser.add_option<bool>(
+        "restart",
+        "start every iteration from the initial state",
+        "true");
+    SearchEngine::add_options_to_parser(parser);
+    Options opts = parser.parse();
+
+    if (parser.help_mode())
+        return nullptr;
+
+    opts.verify_list_non_empty<int>("weights");
+    for (int weight : opts.get_list<int>("weights")) {
+        if (weight < 0) {
+            parser.error("weights must be non-negative");
+        }
+    }
+
+    if (parser.dry_run()) {
+        return nullptr;
+    } else {
+        return make_shared<AnytimeWeightedAStarSearch>(opts);
+    }
+}
+
+static Plugin<SearchEngine> _plugin("anytime_wastar", _parse);
+}
@@ -0,0 +1,98 @@
+#ifndef SEARCH_ENGINES_ANYTIME_WEIGHTED_ASTAR_SEARCH_H
+#define SEARCH_ENGINES_ANYTIME_WEIGHTED_ASTAR_SEARCH_H
+
+#include "../open_list.h"
+#include "../operator_id.h"
+#include "../per_state_information.h"
+#include "../search_engine.h"
+
+#include <memory>
+#include <vector>
+
+class Evaluator;
+
+namespace options {
+class Options;
+}
+
+namespace anytime_weighted_astar_search {
+/*
+  Search node of a state. Unlike SearchNodeInfo, it stores the heuristic
+  value, which is computed once and reused in all later iterations.
+*/
+struct NodeInfo {
+    static const int NOT_EVALUATED = -1;
+
+    int h;
+    int g;
+    int real_g;
+    // The iteration in which the node was last inserted into the open list.
+    int iteration;
+    bool closed;
+    // Only used without restarts (see the comment on inconsistent_states).
+    bool inconsistent;
+    StateID parent_state_id;
+    OperatorID creating_operator;
+
+    NodeInfo()
+        : h(NOT_EVALUATED), g(-1), real_g(-1), iteration(-1), closed(false),
+          inconsistent(false), parent_state_id(StateID::no_state),
+          creating_operator(OperatorID::no_operator) {
+    }
+};
+
+/*
+  Anytime weighted A* that runs one iteration per weight and keeps the
+  state registry, the search nodes and the heuristic values of all states
+  between iterations. Every iteration starts with a new open list ordered
+  by g + w * h with the weight of the iteration. After an iteration finds
+  a plan, its cost becomes the bound for all later iterations.
+
+  With restarts (RWA*), every iteration starts from the initial state.
+  States that were reached in earlier iterations are inserted into the
+  new open list with their best known g value when they are reached
+  again, without evaluating them again. Closed states whose g value
+  decreases are reopened.
+
+  Without restarts (anytime repairing A*), every iteration continues with
+  the open states of the previous one. Closed states whose g value
+  decreases are not reopened within an iteration. They are inserted into
+  the open list of the next iteration instead.
+
+  After the last weight, the search continues with the same open list and
+  the lowered bound until it is exhausted.
+*/
+class AnytimeWeightedAStarSearch : public SearchEngine {
+    const std::shared_ptr<Evaluator> evaluator;
+    const std::vector<int> weights;
+    const bool restart;
+
+    PerStateInformation<NodeInfo> search_nodes;
+    std::unique_ptr<StateOpenList> open_list;
+    std::vector<Evaluator *> path_dependent_evaluators;
+    // Closed states whose g value decreased during the current iteration.
+    std::vector<StateID> inconsistent_states;
+    int iteration;
+    int num_plans;
+
+    int get_weight() const;
+    bool is_closed(const NodeInfo &info) const;
+    void insert(const State &state, const NodeInfo &info);
+    void start_iteration();
+    void expand(const State &state);
+    bool report_plan(const State &goal_state);
+
+protected:
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+
+public:
+    explicit AnytimeWeightedAStarSearch(const options::Options &opts);
+    virtual ~AnytimeWeightedAStarSearch() = default;
+
+    virtual void print_statistics() const override;
+    virtual void save_plan_if_necessary() override;
+};
+}
+
+#endif
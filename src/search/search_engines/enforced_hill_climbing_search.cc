@@ -1,5 +1,7 @@
 #include "enforced_hill_climbing_search.h"
 
+#include "parallel_search_common.h"
+
 #include "../option_parser.h"
 #include "../plugin.h"
 
@@ -10,8 +12,12 @@
 #include "../open_lists/tiebreaking_open_list.h"
 #include "../task_utils/successor_generator.h"
 #include "../utils/logging.h"
+#include "../utils/memory.h"
 #include "../utils/system.h"
 
+#include <algorithm>
+#include <thread>
+
 using namespace std;
 using utils::ExitCode;
 
@@ -60,15 +66,29 @@ static shared_ptr<OpenListFactory> create_ehc_open_list_factory(
     }
 }
 
+/*
+  In the parallel breadth-first search, every thread evaluates at least
+  this many states of a layer. Smaller layers use fewer threads, since
+  starting a thread costs about as much as evaluating a few states.
+*/
+static const size_t MIN_STATES_PER_THREAD = 4;
+
+EnforcedHillClimbingSearch::Worker::Worker(
+    const shared_ptr<Evaluator> &evaluator, utils::LogProxy &log)
+    : evaluator(evaluator),
+      statistics(log),
+      num_reported_evaluations(0) {
+}
 
 EnforcedHillClimbingSearch::EnforcedHillClimbingSearch(
-    const Options &opts)
+    const Options &opts, const vector<shared_ptr<Evaluator>> &heuristics)
     : SearchEngine(opts),
       evaluator(opts.get<shared_ptr<Evaluator>>("h")),
       preferred_operator_evaluators(opts.get_list<shared_ptr<Evaluator>>("preferred")),
       preferred_usage(opts.get<PreferredUsage>("preferred_usage")),
       current_eval_context(state_registry.get_initial_state(), &statistics),
       current_phase_start_g(-1),
+      reached_in_phase(-1),
       num_ehc_phases(0),
       last_num_expanded(-1) {
     for (const shared_ptr<Evaluator> &eval : preferred_operator_evaluators) {
@@ -86,6 +106,18 @@ EnforcedHillClimbingSearch::EnforcedHillClimbingSearch(
 
     open_list = create_ehc_open_list_factory(
         use_preferred, preferred_usage)->create_edge_open_list();
+
+    assert(!heuristics.empty() && heuristics[0] == evaluator);
+    if (heuristics.size() > 1) {
+        if (!path_dependent_evaluators.empty()) {
+            cerr << "ehc with several threads does not support "
+                 << "path-dependent evaluators." << endl;
+            utils::exit_with(ExitCode::SEARCH_UNSUPPORTED);
+        }
+        for (const shared_ptr<Evaluator> &heuristic : heuristics) {
+            workers.push_back(utils::make_unique_ptr<Worker>(heuristic, log));
+        }
+    }
 }
 
 EnforcedHillClimbingSearch::~EnforcedHillClimbingSearch() {
@@ -110,6 +142,12 @@ void EnforcedHillClimbingSearch::initialize() {
 
     bool dead_end = current_eval_context.is_evaluator_value_infinite(evaluator.get());
     statistics.inc_evaluated_states();
+    vector<shared_ptr<Evaluator>> other_evaluators;
+    for (size_t i = 1; i < workers.size(); ++i) {
+        other_evaluators.push_back(workers[i]->evaluator);
+    }
+    parallel_search_common::subscribe_evaluators(
+        current_eval_context.get_state(), other_evaluators);
     print_initial_evaluator_values(current_eval_context, log);
 
     if (dead_end) {
@@ -185,8 +223,22 @@ SearchStatus EnforcedHillClimbingSearch::step() {
         return SOLVED;
     }
 
-    expand(current_eval_context);
-    return ehc();
+    if (workers.empty()) {
+        expand(current_eval_context);
+        return ehc();
+    } else {
+        return parallel_ehc();
+    }
+}
+
+void EnforcedHillClimbingSearch::report_phase(int d) {
+    ++num_ehc_phases;
+    if (d_counts.count(d) == 0) {
+        d_counts[d] = make_pair(0, 0);
+    }
+    pair<int, int> &d_pair = d_counts[d];
+    d_pair.first += 1;
+    d_pair.second += statistics.get_expanded() - last_num_expanded;
 }
 
 SearchStatus EnforcedHillClimbingSearch::ehc() {
@@ -226,13 +278,7 @@ SearchStatus EnforcedHillClimbingSearch::ehc() {
             node.open(parent_node, last_op, get_adjusted_cost(last_op));
 
             if (h < current_eval_context.get_evaluator_value(evaluator.get())) {
-                ++num_ehc_phases;
-                if (d_counts.count(d) == 0) {
-                    d_counts[d] = make_pair(0, 0);
-                }
-                pair<int, int> &d_pair = d_counts[d];
-                d_pair.first += 1;
-                d_pair.second += statistics.get_expanded() - last_num_expanded;
+                report_phase(d);
 
                 current_eval_context = move(eval_context);
                 open_list->clear();
@@ -247,6 +293,172 @@ SearchStatus EnforcedHillClimbingSearch::ehc() {
     return FAILED;
 }
 
+void EnforcedHillClimbingSearch::expand_into_next_layer(const State &state) {
+    vector<OperatorID> successor_operators;
+    successor_generator.generate_applicable_ops(state, successor_operators);
+    for (OperatorID op_id : successor_operators) {
+        next_layer.emplace_back(state.get_id(), op_id);
+    }
+    statistics.inc_generated_ops(successor_operators.size());
+    statistics.inc_expanded();
+}
+
+/*
+  Evaluate the layer states with the heuristic of the given worker until
+  all states before the first state with a lower heuristic value than
+  current_h are evaluated. Threads take the states in the order of the
+  layer, so all states before first_improving_index are evaluated when
+  all threads have returned.
+*/
+void EnforcedHillClimbingSearch::evaluate_layer_states(
+    Worker &worker, int current_h, atomic<size_t> &next_index,
+    atomic<size_t> &first_improving_index) {
+    for (;;) {
+        size_t index = next_index.fetch_add(1);
+        if (index >= first_improving_index.load()) {
+            return;
+        }
+        LayerState &layer_state = layer_states[index];
+        EvaluationContext eval_context(layer_state.state, &worker.statistics);
+        layer_state.result = eval_context.get_result(worker.evaluator.get());
+        if (!layer_state.result.is_infinite() &&
+            layer_state.result.get_evaluator_value() < current_h) {
+            size_t first_index = first_improving_index.load();
+            while (index < first_index &&
+                   !first_improving_index.compare_exchange_weak(
+                       first_index, index)) {
+            }
+        }
+    }
+}
+
+/*
+  Evaluate the layer states on several threads and return the index of
+  the first state with a lower heuristic value than current_h, or the
+  number of layer states if there is none.
+*/
+size_t EnforcedHillClimbingSearch::evaluate_layer(int current_h) {
+    atomic<size_t> next_index(0);
+    atomic<size_t> first_improving_index(layer_states.size());
+    size_t num_threads = min(
+        workers.size(),
+        max(layer_states.size() / MIN_STATES_PER_THREAD, size_t(1)));
+    vector<thread> threads;
+    for (size_t i = 1; i < num_threads; ++i) {
+        threads.emplace_back(
+            &EnforcedHillClimbingSearch::evaluate_layer_states, this,
+            ref(*workers[i]), current_h, ref(next_index),
+            ref(first_improving_index));
+    }
+    evaluate_layer_states(
+        *workers[0], current_h, next_index, first_improving_index);
+    for (thread &worker_thread : threads) {
+        worker_thread.join();
+    }
+
+    for (const unique_ptr<Worker> &worker : workers) {
+        int num_evaluations = worker->statistics.get_evaluations();
+        statistics.inc_evaluations(
+            num_evaluations - worker->num_reported_evaluations);
+        worker->num_reported_evaluations = num_evaluations;
+    }
+    return first_improving_index.load();
+}
+
+/*
+  Breadth-first search from the current state for a state with a lower
+  heuristic value, expanding one layer (all states at the same depth) at
+  a time. The main thread generates the successors of a layer and
+  registers them. Successors that are new in the search space and have
+  not been reached before in the current EHC phase (see
+  reached_in_phase) form the next layer. All threads then evaluate
+  the layer, and the main thread processes it in order until the first
+  state with a lower heuristic value, which starts the next phase. Only
+  the evaluated states are opened in the search space, so the states
+  after the first improving one stay new and can be reached in later
+  phases, as in ehc().
+
+  Unlike ehc(), the search orders states by depth rather than by g, and
+  preferred operators are not supported.
+*/
+SearchStatus EnforcedHillClimbingSearch::parallel_ehc() {
+    int current_h = current_eval_context.get_evaluator_value(evaluator.get());
+    const State &current_state = current_eval_context.get_state();
+    current_layer.clear();
+    next_layer.clear();
+    reached_in_phase[current_state] = num_ehc_phases;
+    expand_into_next_layer(current_state);
+    search_space.get_node(current_state).close();
+
+    while (!next_layer.empty()) {
+        current_layer.swap(next_layer);
+        next_layer.clear();
+
+        vector<pair<StateID, EdgeOpenListEntry>> layer_transitions;
+        for (const EdgeOpenListEntry &entry : current_layer) {
+            State parent_state = state_registry.lookup_state(entry.first);
+            SearchNode parent_node = search_space.get_node(parent_state);
+            OperatorProxy op = task_proxy.get_operators()[entry.second];
+            if (parent_node.get_real_g() + op.get_cost() >= bound)
+                continue;
+
+            State state = state_registry.get_successor_state(parent_state, op);
+            statistics.inc_generated();
+            int &phase = reached_in_phase[state];
+            if (search_space.get_node(state).is_new() &&
+                phase != num_ehc_phases) {
+                phase = num_ehc_phases;
+                layer_transitions.emplace_back(state.get_id(), entry);
+            }
+        }
+
+        /*
+          No states are registered while the layer is evaluated, so the
+          states we look up here stay valid (see state_registry.h).
+        */
+        layer_states.clear();
+        for (const pair<StateID, EdgeOpenListEntry> &transition : layer_transitions) {
+            layer_states.emplace_back(
+                state_registry.lookup_state(transition.first),
+                transition.second.first, transition.second.second);
+        }
+        size_t first_improving_index = evaluate_layer(current_h);
+
+        size_t num_evaluated_states =
+            min(first_improving_index + 1, layer_states.size());
+        for (size_t i = 0; i < num_evaluated_states; ++i) {
+            const LayerState &layer_state = layer_states[i];
+            SearchNode node = search_space.get_node(layer_state.state);
+            statistics.inc_evaluated_states();
+            if (layer_state.result.is_infinite()) {
+                node.mark_as_dead_end();
+                statistics.inc_dead_ends();
+                continue;
+            }
+            SearchNode parent_node = search_space.get_node(
+                state_registry.lookup_state(layer_state.parent_id));
+            OperatorProxy op = task_proxy.get_operators()[layer_state.op_id];
+            node.open(parent_node, op, get_adjusted_cost(op));
+            if (i == first_improving_index) {
+                report_phase(node.get_g() - current_phase_start_g);
+                current_eval_context = EvaluationContext(
+                    layer_state.state, &statistics);
+                // The evaluation counted for the worker that computed it.
+                EvaluationResult result = layer_state.result;
+                result.set_count_evaluation(false);
+                current_eval_context.set_result(evaluator.get(), result);
+                current_phase_start_g = node.get_g();
+                return IN_PROGRESS;
+            } else {
+                expand_into_next_layer(layer_state.state);
+                node.close();
+            }
+        }
+    }
+    log << "No solution - FAILED" << endl;
+    return FAILED;
+}
+
 void EnforcedHillClimbingSearch::print_statistics() const {
     statistics.print_detailed_statistics();
 
@@ -269,7 +481,18 @@ void EnforcedHillClimbingSearch::print_statistics() const {
 
 static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
     parser.document_synopsis("Lazy enforced hill-climbing", "");
-    parser.add_option<shared_ptr<Evaluator>>("h", "heuristic");
+    parser.document_note(
+        "Parallel plateau escape",
+        "With threads > 1, the breadth-first search that looks for a state "
+        "with a lower heuristic value proceeds layer by layer. All threads "
+        "evaluate the new states of a layer, and the search stops at the "
+        "first state of the layer with a lower heuristic value. States are "
+        "ordered by depth rather than by g, which only makes a difference "
+        "for tasks with different action costs. Every thread has its own "
+        "copy of the heuristic, so the heuristic must be defined inline "
+        "rather than predefined with --evaluator. Preferred operators and "
+        "path-dependent heuristics are not supported in this mode.");
+    parser.add_option<ParseTree>("h", "heuristic");
     vector<string> preferred_usages;
     preferred_usages.push_back("PRUNE_BY_PREFERRED");
     preferred_usages.push_back("RANK_PREFERRED_FIRST");
@@ -282,13 +505,29 @@ static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
         "preferred",
         "use preferred operators of these evaluators",
         "[]");
+    parallel_search_common::add_threads_option_to_parser(parser);
     SearchEngine::add_options_to_parser(parser);
     Options opts = parser.parse();
 
+    if (parser.help_mode()) {
+        return nullptr;
+    }
+
+    int num_threads = opts.get<int>("threads");
+    if (num_threads > 1 &&
+        !opts.get_list<shared_ptr<Evaluator>>("preferred").empty()) {
+        parser.error("ehc with threads > 1 does not support preferred operators");
+    }
+
+    vector<shared_ptr<Evaluator>> heuristics =
+        parallel_search_common::create_evaluators_for_threads(
+            parser, opts.get<ParseTree>("h"), num_threads);
+
     if (parser.dry_run())
         return nullptr;
-    else
-        return make_shared<EnforcedHillClimbingSearch>(opts);
+
+    opts.set("h", heuristics[0]);
+    return make_shared<EnforcedHillClimbingSearch>(opts, heuristics);
 }
 
 static Plugin<SearchEngine> _plugin("ehc", _parse);
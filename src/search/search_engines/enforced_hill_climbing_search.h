@@ -2,9 +2,14 @@
 #define SEARCH_ENGINES_ENFORCED_HILL_CLIMBING_SEARCH_H
 
 #include "../evaluation_context.h"
+#include "../evaluation_result.h"
 #include "../open_list.h"
+#include "../per_state_information.h"
 #include "../search_engine.h"
+#include "../search_statistics.h"
 
+#include <atomic>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <set>
@@ -24,11 +29,44 @@ enum class PreferredUsage {
 /*
   Enforced hill-climbing with deferred evaluation.
 
+  With several threads, the breadth-first search that escapes a plateau
+  proceeds layer by layer (see parallel_ehc). The main thread generates
+  the states of a layer and all threads evaluate them.
+
   TODO: We should test if this lazy implementation really has any benefits over
   an eager one. We hypothesize that both versions need to evaluate and store
   the same states anyways.
 */
 class EnforcedHillClimbingSearch : public SearchEngine {
+    /*
+      Data of one thread that evaluates states in the parallel
+      breadth-first search. Every thread has its own copy of the
+      heuristic; the first thread is the main thread and uses the
+      heuristic of the engine.
+    */
+    struct Worker {
+        std::shared_ptr<Evaluator> evaluator;
+        SearchStatistics statistics;
+        // Evaluations that have been added to the engine statistics.
+        int num_reported_evaluations;
+
+        Worker(const std::shared_ptr<Evaluator> &evaluator,
+               utils::LogProxy &log);
+    };
+
+    // A new state in the current layer of the parallel breadth-first search.
+    struct LayerState {
+        State state;
+        // The transition by which the layer reached the state first.
+        StateID parent_id;
+        OperatorID op_id;
+        EvaluationResult result;
+
+        LayerState(const State &state, StateID parent_id, OperatorID op_id)
+            : state(state), parent_id(parent_id), op_id(op_id) {
+        }
+    };
+
     std::unique_ptr<EdgeOpenList> open_list;
 
     std::shared_ptr<Evaluator> evaluator;
@@ -40,6 +78,13 @@ class EnforcedHillClimbingSearch : public SearchEngine {
     EvaluationContext current_eval_context;
     int current_phase_start_g;
 
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<EdgeOpenListEntry> current_layer;
+    std::vector<EdgeOpenListEntry> next_layer;
+    std::vector<LayerState> layer_states;
+    // The EHC phase (num_ehc_phases) in which a state was last reached.
+    PerStateInformation<int> reached_in_phase;
+
     // Statistics
     std::map<int, std::pair<int, int>> d_counts;
     int num_ehc_phases;
@@ -53,14 +98,28 @@ class EnforcedHillClimbingSearch : public SearchEngine {
     void expand(EvaluationContext &eval_context);
     void reach_state(
         const State &parent, OperatorID op_id, const State &state);
+    void report_phase(int d);
     SearchStatus ehc();
 
+    void expand_into_next_layer(const State &state);
+    void evaluate_layer_states(
+        Worker &worker, int current_h, std::atomic<std::size_t> &next_index,
+        std::atomic<std::size_t> &first_improving_index);
+    std::size_t evaluate_layer(int current_h);
+    SearchStatus parallel_ehc();
+
 protected:
     virtual void initialize() override;
     virtual SearchStatus step() override;
 
 public:
-    explicit EnforcedHillClimbingSearch(const options::Options &opts);
+    /*
+      The given heuristics are the copies of the heuristic "h" for the
+      threads that evaluate states, with the heuristic "h" itself first.
+    */
+    EnforcedHillClimbingSearch(
+        const options::Options &opts,
+        const std::vector<std::shared_ptr<Evaluator>> &heuristics);
     virtual ~EnforcedHillClimbingSearch() override;
 
     virtual void print_statistics() const override;
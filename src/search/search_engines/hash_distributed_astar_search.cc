@@ -0,0 +1,387 @@
+#include "hash_distributed_astar_search.h"
+
+#include "parallel_search_common.h"
+#include "search_common.h"
+
+#include "../evaluation_context.h"
+#include "../evaluator.h"
+#include "../open_list_factory.h"
+#include "../option_parser.h"
+#include "../option_parser_util.h"
+#include "../plugin.h"
+
+#include "../task_utils/successor_generator.h"
+#include "../task_utils/task_properties.h"
+#include "../task_utils/zobrist_hasher.h"
+#include "../utils/countdown_timer.h"
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <set>
+#include <thread>
+
+using namespace std;
+
+namespace hash_distributed_astar_search {
+HashDistributedAStarSearch::Worker::Worker(
+    const shared_ptr<Evaluator> &f_evaluator,
+    unique_ptr<StateOpenList> open_list, int num_threads, utils::LogProxy &log)
+    : f_evaluator(f_evaluator),
+      open_list(move(open_list)),
+      outboxes(num_threads),
+      statistics(log),
+      num_unfinished_messages(0),
+      num_sent_messages(0) {
+}
+
+HashDistributedAStarSearch::HashDistributedAStarSearch(
+    const Options &opts, const vector<shared_ptr<Evaluator>> &heuristics)
+    : SearchEngine(opts),
+      num_threads(opts.get<int>("threads")),
+      zobrist_hashing(opts.get<bool>("zobrist_hashing")),
+      zobrist_hasher(zobrist_hasher::g_zobrist_hashers[task_proxy]),
+      shared_registry(task_proxy, true, zobrist_hashing),
+      search_nodes(shared_registry),
+      num_unfinished_messages(0),
+      search_finished(false),
+      incumbent_g(numeric_limits<int>::max()),
+      incumbent_goal(StateID::no_state) {
+    assert(static_cast<int>(heuristics.size()) == num_threads);
+    for (const shared_ptr<Evaluator> &heuristic : heuristics) {
+        Options astar_opts;
+        astar_opts.set("eval", heuristic);
+        auto open_list_factory_and_f_eval =
+            search_common::create_astar_open_list_factory_and_f_eval(astar_opts);
+        unique_ptr<StateOpenList> open_list =
+            open_list_factory_and_f_eval.first->create_state_open_list();
+        set<Evaluator *> path_dependent_evaluators;
+        open_list->get_path_dependent_evaluators(path_dependent_evaluators);
+        if (!path_dependent_evaluators.empty()) {
+            cerr << "hdastar does not support path-dependent evaluators."
+                 << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_UNSUPPORTED);
+        }
+        workers.push_back(utils::make_unique_ptr<Worker>(
+                              open_list_factory_and_f_eval.second,
+                              move(open_list), num_threads, log));
+    }
+}
+
+int HashDistributedAStarSearch::get_owner(const State &state) const {
+    int_hash_set::HashType hash;
+    if (zobrist_hashing) {
+        hash = shared_registry.get_zobrist_hash(state);
+    } else {
+        hash = zobrist_hasher.compute_hash(state.get_buffer());
+    }
+    return hash % num_threads;
+}
+
+void HashDistributedAStarSearch::initialize() {
+    log << "Conducting hash-distributed A* search with " << num_threads
+        << " thread(s), (real) bound = " << bound << endl;
+    State initial_state = shared_registry.get_initial_state();
+    int owner = get_owner(initial_state);
+
+    vector<shared_ptr<Evaluator>> other_evaluators;
+    for (int i = 0; i < num_threads; ++i) {
+        if (i != owner) {
+            other_evaluators.push_back(workers[i]->f_evaluator);
+        }
+    }
+    parallel_search_common::subscribe_evaluators(initial_state, other_evaluators);
+    Worker &owner_worker = *workers[owner];
+    EvaluationContext eval_context(
+        initial_state, 0, true, &owner_worker.statistics);
+    if (owner_worker.open_list->is_dead_end(eval_context)) {
+        log << "Initial state is a dead end." << endl;
+    }
+    print_initial_evaluator_values(eval_context, log);
+
+    /*
+      The initial state is delivered like any other state, so it counts as
+      an unfinished message until its owner runs out of work.
+    */
+    num_unfinished_messages = 1;
+    vector<Message> initial_message;
+    initial_message.emplace_back(
+        initial_state.get_id(), StateID::no_state, OperatorID::no_operator, 0, 0);
+    owner_worker.inbox.push(move(initial_message));
+}
+
+void HashDistributedAStarSearch::process_message(
+    Worker &worker, const Message &message) {
+    if (message.g >= incumbent_g.load(memory_order_relaxed)) {
+        return;
+    }
+    NodeInfo &info = search_nodes[message.state_id];
+    if (info.status == SearchNodeInfo::DEAD_END) {
+        return;
+    }
+    bool is_new = (info.status == SearchNodeInfo::NEW);
+    if (!is_new && info.g <= message.g) {
+        return;
+    }
+
+    State state = shared_registry.lookup_state(message.state_id);
+    EvaluationContext eval_context(
+        state, message.g, false, &worker.statistics);
+    if (is_new) {
+        worker.statistics.inc_evaluated_states();
+        if (worker.open_list->is_dead_end(eval_context)) {
+            info.status = SearchNodeInfo::DEAD_END;
+            worker.statistics.inc_dead_ends();
+            return;
+        }
+    } else if (info.status == SearchNodeInfo::CLOSED) {
+        worker.statistics.inc_reopened();
+    }
+    info.status = SearchNodeInfo::OPEN;
+    info.g = message.g;
+    info.real_g = message.real_g;
+    info.parent_state_id = message.parent_id;
+    info.creating_operator = message.creating_operator;
+    worker.open_list->insert(eval_context, message.state_id);
+}
+
+bool HashDistributedAStarSearch::receive_messages(Worker &worker) {
+    vector<Message> &messages = worker.received_messages;
+    if (!worker.inbox.pop_all(messages)) {
+        return false;
+    }
+    worker.num_unfinished_messages += messages.size();
+    for (const Message &message : messages) {
+        process_message(worker, message);
+    }
+    messages.clear();
+    return true;
+}
+
+void HashDistributedAStarSearch::send_messages(Worker &worker) {
+    for (int i = 0; i < num_threads; ++i) {
+        vector<Message> &outbox = worker.outboxes[i];
+        if (!outbox.empty()) {
+            worker.num_sent_messages += outbox.size();
+            // Count the messages before the receiver can see them.
+            num_unfinished_messages.fetch_add(outbox.size());
+            workers[i]->inbox.push(move(outbox));
+        }
+    }
+}
+
+/*
+  Expand the state with the lowest f value in the open list of the worker.
+  States that belong to the worker are processed immediately; all other
+  successors are collected in the outboxes.
+
+  The open lists are ordered by f value, so as soon as the lowest f value
+  reaches the cost of the incumbent plan, nothing in the open list can
+  lead to a cheaper plan and we discard all of it.
+*/
+void HashDistributedAStarSearch::expand_next_node(Worker &worker) {
+    StateID id = worker.open_list->remove_min();
+    NodeInfo &info = search_nodes[id];
+    if (info.status != SearchNodeInfo::OPEN) {
+        return;
+    }
+    State state = shared_registry.lookup_state(id);
+    // The heuristic value is cached since the state was inserted.
+    EvaluationContext eval_context(state, info.g, false, &worker.statistics);
+    int f = eval_context.get_evaluator_value_or_infinity(
+        worker.f_evaluator.get());
+    if (f >= incumbent_g.load(memory_order_relaxed)) {
+        worker.open_list->clear();
+        return;
+    }
+    info.status = SearchNodeInfo::CLOSED;
+    worker.statistics.inc_expanded();
+
+    if (task_properties::is_goal_state(task_proxy, state)) {
+        lock_guard<mutex> lock(incumbent_mutex);
+        if (info.g < incumbent_g.load(memory_order_relaxed)) {
+            log << "Found plan with cost " << info.g << endl;
+            incumbent_g = info.g;
+            incumbent_goal = id;
+        }
+        return;
+    }
+
+    int g = info.g;
+    int real_g = info.real_g;
+    vector<OperatorID> &applicable_ops = worker.applicable_ops;
+    applicable_ops.clear();
+    successor_generator.generate_applicable_ops(state, applicable_ops);
+    worker.statistics.inc_generated_ops(applicable_ops.size());
+    for (OperatorID op_id : applicable_ops) {
+        OperatorProxy op = task_proxy.get_operators()[op_id];
+        if (real_g + op.get_cost() >= bound) {
+            continue;
+        }
+        int succ_g = g + get_adjusted_cost(op);
+        if (succ_g >= incumbent_g.load(memory_order_relaxed)) {
+            continue;
+        }
+        State succ_state = shared_registry.get_successor_state(state, op);
+        worker.statistics.inc_generated();
+        Message message(succ_state.get_id(), id, op_id, succ_g,
+                        real_g + op.get_cost());
+        int owner = get_owner(succ_state);
+        if (workers[owner].get() == &worker) {
+            process_message(worker, message);
+        } else {
+            worker.outboxes[owner].push_back(message);
+        }
+    }
+}
+
+void HashDistributedAStarSearch::run_worker(
+    Worker &worker, const utils::CountdownTimer &timer) {
+    while (!search_finished.load(memory_order_acquire)) {
+        receive_messages(worker);
+        if (!worker.open_list->empty()) {
+            expand_next_node(worker);
+            send_messages(worker);
+        } else {
+            /*
+              The worker ran out of work and all its messages are sent, so
+              it has finished the messages it received.
+            */
+            if (worker.num_unfinished_messages > 0) {
+                num_unfinished_messages.fetch_sub(
+                    worker.num_unfinished_messages);
+                worker.num_unfinished_messages = 0;
+            }
+            if (num_unfinished_messages.load() == 0) {
+                search_finished = true;
+            } else {
+                this_thread::yield();
+            }
+        }
+        if (timer.is_expired() || is_stop_requested()) {
+            search_finished = true;
+        }
+    }
+}
+
+void HashDistributedAStarSearch::trace_path(StateID goal_id, Plan &plan) {
+    assert(plan.empty());
+    StateID current_id = goal_id;
+    for (;;) {
+        const NodeInfo &info = search_nodes[current_id];
+        if (info.creating_operator == OperatorID::no_operator) {
+            assert(info.parent_state_id == StateID::no_state);
+            break;
+        }
+        plan.push_back(info.creating_operator);
+        current_id = info.parent_state_id;
+    }
+    reverse(plan.begin(), plan.end());
+}
+
+/*
+  A single step runs all worker threads until the search space is
+  exhausted up to the cost of the best plan, or until the time limit is
+  reached.
+*/
+SearchStatus HashDistributedAStarSearch::step() {
+    utils::CountdownTimer timer(max_time);
+    vector<thread> threads;
+    for (int i = 1; i < num_threads; ++i) {
+        threads.emplace_back(&HashDistributedAStarSearch::run_worker, this,
+                             ref(*workers[i]), cref(timer));
+    }
+    run_worker(*workers[0], timer);
+    for (thread &worker_thread : threads) {
+        worker_thread.join();
+    }
+
+    for (const unique_ptr<Worker> &worker : workers) {
+        parallel_search_common::add_worker_statistics(
+            statistics, worker->statistics);
+    }
+
+    if (num_unfinished_messages.load() != 0) {
+        // SearchEngine::search() reports the timeout.
+        return IN_PROGRESS;
+    }
+    if (incumbent_goal == StateID::no_state) {
+        log << "Completely explored state space -- no solution!" << endl;
+        return FAILED;
+    }
+    log << "Solution found!" << endl;
+    Plan plan;
+    trace_path(incumbent_goal, plan);
+    set_plan(plan);
+    return SOLVED;
+}
+
+void HashDistributedAStarSearch::print_statistics() const {
+    statistics.print_detailed_statistics();
+    log << "Expanded states per thread:";
+    long long num_sent_messages = 0;
+    for (const unique_ptr<Worker> &worker : workers) {
+        log << " " << worker->statistics.get_expanded();
+        num_sent_messages += worker->num_sent_messages;
+    }
+    log << endl;
+    log << "Messages between threads: " << num_sent_messages << endl;
+    shared_registry.print_statistics(log);
+}
+
+static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Hash-distributed A* search",
+        "A* search with several worker threads (HDA*). Every state is "
+        "owned by one thread, chosen by a Zobrist hash of the state (which "
+        "the state registry stores with zobrist_hashing=true). Each "
+        "thread has its own open list and evaluators, and expands the "
+        "states it owns in A* order. Successors are sent to their owners "
+        "through lock-free queues, which perform the duplicate detection "
+        "and evaluation. All threads share a thread-safe state registry.");
+    parser.document_note(
+        "Optimality",
+        "The first plan that a thread finds need not be optimal, so threads "
+        "continue until every open list only contains states whose f value "
+        "is not lower than the cost of the best plan. With an admissible "
+        "heuristic, the resulting plan is optimal. Closed nodes are "
+        "re-opened.");
+    parser.document_note(
+        "Evaluators",
+        "Every thread has its own copy of the evaluator, so the evaluator "
+        "must be defined inline rather than predefined with --evaluator. "
+        "Path-dependent evaluators are not supported. Heuristic values are "
+        "looked up again when a state is expanded, so the evaluator should "
+        "cache its estimates.");
+    parser.add_option<ParseTree>("eval", "evaluator for h-value");
+    parallel_search_common::add_threads_option_to_parser(parser);
+    SearchEngine::add_options_to_parser(parser);
+    Options opts = parser.parse();
+
+    if (parser.help_mode()) {
+        return nullptr;
+    }
+
+    if (opts.get<bool>("compress_states")) {
+        parser.error("hdastar does not support compress_states");
+    }
+    if (opts.contains("state_pool_directory")) {
+        parser.error("hdastar does not support state_pool_directory");
+    }
+
+    vector<shared_ptr<Evaluator>> heuristics =
+        parallel_search_common::create_evaluators_for_threads(
+            parser, opts.get<ParseTree>("eval"), opts.get<int>("threads"));
+
+    shared_ptr<HashDistributedAStarSearch> engine;
+    if (!parser.dry_run()) {
+        engine = make_shared<HashDistributedAStarSearch>(opts, heuristics);
+    }
+
+    return engine;
+}
+
+static Plugin<SearchEngine> _plugin("hdastar", _parse);
+}
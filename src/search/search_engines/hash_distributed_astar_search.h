@@ -0,0 +1,131 @@
+#ifndef SEARCH_ENGINES_HASH_DISTRIBUTED_ASTAR_SEARCH_H
+#define SEARCH_ENGINES_HASH_DISTRIBUTED_ASTAR_SEARCH_H
+
+#include "../concurrent_per_state_information.h"
+#include "../open_list.h"
+#include "../operator_id.h"
+#include "../search_engine.h"
+#include "../search_node_info.h"
+#include "../search_statistics.h"
+#include "../state_registry.h"
+
+#include "../algorithms/mpsc_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Evaluator;
+
+namespace options {
+class Options;
+}
+
+namespace utils {
+class CountdownTimer;
+}
+
+namespace zobrist_hasher {
+class ZobristHasher;
+}
+
+namespace hash_distributed_astar_search {
+/*
+  A path to a state that a worker generated and sends to the worker that
+  owns the state.
+*/
+struct Message {
+    StateID state_id;
+    StateID parent_id;
+    OperatorID creating_operator;
+    int g;
+    int real_g;
+
+    Message(StateID state_id, StateID parent_id, OperatorID creating_operator,
+            int g, int real_g)
+        : state_id(state_id), parent_id(parent_id),
+          creating_operator(creating_operator), g(g), real_g(real_g) {
+    }
+};
+
+// Workers always store parent pointers, since they trace the plan.
+struct NodeInfo : public SearchNodeInfo, public SearchNodeParentInfo {
+};
+
+class HashDistributedAStarSearch : public SearchEngine {
+    /*
+      Data of one worker thread. Every worker has its own evaluators and
+      open list, and only the owner of a state accesses its search node.
+    */
+    struct Worker {
+        std::shared_ptr<Evaluator> f_evaluator;
+        std::unique_ptr<StateOpenList> open_list;
+        mpsc_queue::MPSCQueue<Message> inbox;
+        // Messages for the other workers that are sent after an expansion.
+        std::vector<std::vector<Message>> outboxes;
+        std::vector<Message> received_messages;
+        std::vector<OperatorID> applicable_ops;
+        SearchStatistics statistics;
+        /*
+          Number of messages that the worker received since it last ran out
+          of work (see the comment on num_unfinished_messages below).
+        */
+        long long num_unfinished_messages;
+        long long num_sent_messages;
+
+        Worker(const std::shared_ptr<Evaluator> &f_evaluator,
+               std::unique_ptr<StateOpenList> open_list,
+               int num_threads, utils::LogProxy &log);
+    };
+
+    const int num_threads;
+    /*
+      The owner of a state is given by its Zobrist hash. With
+      zobrist_hashing, the registry stores this hash for every state.
+    */
+    const bool zobrist_hashing;
+    const zobrist_hasher::ZobristHasher &zobrist_hasher;
+
+    // Shared by all workers; SearchEngine::state_registry is not used.
+    StateRegistry shared_registry;
+    ConcurrentPerStateInformation<NodeInfo> search_nodes;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /*
+      Number of messages that have been sent but not received, plus the
+      messages whose receivers have not run out of work since receiving
+      them. When this counter drops to 0, all queues are empty and all
+      workers are idle, so the search is finished.
+    */
+    std::atomic<long long> num_unfinished_messages;
+    std::atomic<bool> search_finished;
+
+    // Cost (adjusted by cost_type) of the best plan found so far.
+    std::atomic<int> incumbent_g;
+    std::mutex incumbent_mutex;
+    StateID incumbent_goal;
+
+    int get_owner(const State &state) const;
+    void process_message(Worker &worker, const Message &message);
+    bool receive_messages(Worker &worker);
+    void send_messages(Worker &worker);
+    void expand_next_node(Worker &worker);
+    void run_worker(Worker &worker, const utils::CountdownTimer &timer);
+    void trace_path(StateID goal_id, Plan &plan);
+
+protected:
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+
+public:
+    HashDistributedAStarSearch(
+        const options::Options &opts,
+        const std::vector<std::shared_ptr<Evaluator>> &heuristics);
+    virtual ~HashDistributedAStarSearch() = default;
+
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
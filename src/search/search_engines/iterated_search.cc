@@ -135,7 +135,9 @@ static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
         "Note 1",
         "We don't cache heuristic values between search iterations at"
         " the moment. If you perform a LAMA-style iterative search,"
-        " heuristic values will be computed multiple times.");
+        " heuristic values will be computed multiple times. For weighted"
+        " A* with decreasing weights, anytime_wastar keeps the heuristic"
+        " values of all states between iterations.");
     parser.document_note(
         "Note 2",
         "The configuration\n```\n"
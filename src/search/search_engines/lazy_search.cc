@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <utility>
 #include <vector>
 
 using namespace std;
@@ -19,6 +20,7 @@ using namespace std;
 namespace lazy_search {
 LazySearch::LazySearch(const Options &opts)
     : SearchEngine(opts),
+      lookahead(opts.get<int>("lookahead")),
       open_list(opts.get<shared_ptr<OpenListFactory>>("open")->
                 create_edge_open_list()),
       reopen_closed_nodes(opts.get<bool>("reopen_closed")),
@@ -56,6 +58,16 @@ void LazySearch::initialize() {
     }
 
     path_dependent_evaluators.assign(evals.begin(), evals.end());
+    if (lookahead > 1 && !path_dependent_evaluators.empty()) {
+        /*
+          Path-dependent evaluators must be notified about the transition
+          to a state before the state is evaluated, which only happens
+          when the state is processed.
+        */
+        log << "Ignoring lookahead since there are path-dependent "
+            << "evaluators." << endl;
+        lookahead = 1;
+    }
     State initial_state = state_registry.get_initial_state();
     for (Evaluator *evaluator : path_dependent_evaluators) {
         evaluator->notify_initial_state(initial_state);
@@ -115,34 +127,194 @@ void LazySearch::generate_successors() {
     }
 }
 
-SearchStatus LazySearch::fetch_next_state() {
-    if (open_list->empty()) {
-        log << "Completely explored state space -- no solution!" << endl;
-        return FAILED;
+/*
+  Take up to lookahead entries from the open list and register the states
+  they lead to. With lookahead > 1, the new states are evaluated right
+  away. The search order changes accordingly: the successors of the
+  pending states only enter the open list after all pending states have
+  been taken from it.
+*/
+void LazySearch::fetch_pending_states() {
+    assert(pending_states.empty());
+    vector<pair<EdgeOpenListEntry, StateID>> entries;
+    while (static_cast<int>(entries.size()) < lookahead && !open_list->empty()) {
+        EdgeOpenListEntry next = open_list->remove_min();
+        State predecessor = state_registry.lookup_state(next.first);
+        OperatorProxy op = task_proxy.get_operators()[next.second];
+        assert(task_properties::is_applicable(op, predecessor));
+        StateID state_id =
+            state_registry.get_successor_state(predecessor, op).get_id();
+        entries.emplace_back(next, state_id);
     }
 
-    EdgeOpenListEntry next = open_list->remove_min();
+    /*
+      No states are registered until the next call, so the states we look
+      up here stay valid while they are pending (see state_registry.h).
+    */
+    for (const pair<EdgeOpenListEntry, StateID> &entry : entries) {
+        SearchNode pred_node = search_space.get_node(
+            state_registry.lookup_state(entry.first.first));
+        OperatorProxy op = task_proxy.get_operators()[entry.first.second];
+        int g = pred_node.get_g() + get_adjusted_cost(op);
+        int real_g = pred_node.get_real_g() + op.get_cost();
+        /*
+          Note: We mark the node in the evaluation context as "preferred"
+          here. This probably doesn't matter much either way because the
+          node has already been selected for expansion, but eventually we
+          should think more deeply about which path information to
+          associate with the expanded vs. evaluated nodes in lazy search
+          and where to obtain it from.
+        */
+        pending_states.emplace_back(
+            entry.first.first, entry.first.second, g, real_g,
+            EvaluationContext(state_registry.lookup_state(entry.second), g,
+                              true, &statistics));
+    }
 
-    current_predecessor_id = next.first;
-    current_operator_id = next.second;
-    State current_predecessor = state_registry.lookup_state(current_predecessor_id);
-    OperatorProxy current_operator = task_proxy.get_operators()[current_operator_id];
-    assert(task_properties::is_applicable(current_operator, current_predecessor));
-    current_state = state_registry.get_successor_state(current_predecessor, current_operator);
+    if (lookahead > 1) {
+        evaluate_pending_states();
+    }
+}
 
-    SearchNode pred_node = search_space.get_node(current_predecessor);
-    current_g = pred_node.get_g() + get_adjusted_cost(current_operator);
-    current_real_g = pred_node.get_real_g() + current_operator.get_cost();
+/*
+  Evaluate the pending states that are new and not reached by an earlier
+  pending state. Consecutive pending states with the same predecessor,
+  which are usually successors that were inserted together, are
+  evaluated as a batch.
+*/
+void LazySearch::evaluate_pending_states() {
+    size_t batch_begin = 0;
+    size_t batch_end = 0;
+    for (size_t i = 0; i < pending_states.size(); ++i) {
+        PendingState &pending_state = pending_states[i];
+        const State &state = pending_state.eval_context.get_state();
+        if (!search_space.get_node(state).is_new()) {
+            continue;
+        }
+        bool is_duplicate = false;
+        for (size_t j = 0; j < i; ++j) {
+            if (pending_states[j].eval_context.get_state().get_id() ==
+                state.get_id()) {
+                is_duplicate = true;
+                break;
+            }
+        }
+        if (is_duplicate) {
+            continue;
+        }
+        if (batch_begin < batch_end &&
+            pending_states[batch_begin].predecessor_id !=
+            pending_state.predecessor_id) {
+            evaluate_batch(state_registry.lookup_state(
+                               pending_states[batch_begin].predecessor_id),
+                           batch_begin, batch_end);
+            batch_begin = i;
+        } else if (batch_begin == batch_end) {
+            batch_begin = i;
+        }
+        pending_state.is_evaluated = true;
+        batch_end = i + 1;
+    }
+    if (batch_begin < batch_end) {
+        evaluate_batch(state_registry.lookup_state(
+                           pending_states[batch_begin].predecessor_id),
+                       batch_begin, batch_end);
+    }
+}
+
+/*
+  Evaluate the pending states in [begin, end) that are marked as
+  evaluated. They all have the given predecessor.
+
+  We evaluate the first state as usual and then compute the results of
+  the heuristics that this involved for the other states with
+  Evaluator::compute_successor_results. Combining evaluators only see
+  the results and are evaluated afterwards. Heuristics that compute
+  preferred operators are evaluated as usual, since batch evaluations do
+  not report preferred operators.
+*/
+void LazySearch::evaluate_batch(
+    const State &predecessor, size_t begin, size_t end) {
+    EvaluationContext &first_context = pending_states[begin].eval_context;
+    open_list->is_dead_end(first_context);
+
+    vector<Evaluator *> batch_evaluators;
+    first_context.get_cache().for_each_evaluator_result(
+        [&] (const Evaluator *eval, const EvaluationResult &) {
+            if (eval->does_cache_estimates() &&
+                none_of(preferred_operator_evaluators.begin(),
+                        preferred_operator_evaluators.end(),
+                        [eval] (const shared_ptr<Evaluator> &preferred) {
+                            return preferred.get() == eval;
+                        })) {
+                batch_evaluators.push_back(const_cast<Evaluator *>(eval));
+            }
+        });
+
+    for (Evaluator *evaluator : batch_evaluators) {
+        batch_contexts.clear();
+        for (size_t i = begin + 1; i < end; ++i) {
+            const PendingState &pending_state = pending_states[i];
+            if (pending_state.is_evaluated) {
+                batch_contexts.emplace_back(
+                    pending_state.eval_context.get_state(),
+                    pending_state.g, true, nullptr);
+            }
+        }
+        if (batch_contexts.empty()) {
+            return;
+        }
+        evaluator->compute_successor_results(
+            predecessor, batch_contexts, batch_results);
+        size_t result_index = 0;
+        for (size_t i = begin + 1; i < end; ++i) {
+            PendingState &pending_state = pending_states[i];
+            if (pending_state.is_evaluated) {
+                pending_state.eval_context.set_result(
+                    evaluator, batch_results[result_index++]);
+            }
+        }
+    }
+
+    for (size_t i = begin + 1; i < end; ++i) {
+        PendingState &pending_state = pending_states[i];
+        if (pending_state.is_evaluated) {
+            open_list->is_dead_end(pending_state.eval_context);
+        }
+    }
+}
+
+SearchStatus LazySearch::fetch_next_state() {
+    if (pending_states.empty()) {
+        if (open_list->empty()) {
+            log << "Completely explored state space -- no solution!" << endl;
+            return FAILED;
+        }
+        fetch_pending_states();
+    }
+
+    PendingState &next = pending_states.front();
+    current_predecessor_id = next.predecessor_id;
+    current_operator_id = next.operator_id;
+    current_state = next.eval_context.get_state();
 
     /*
-      Note: We mark the node in current_eval_context as "preferred"
-      here. This probably doesn't matter much either way because the
-      node has already been selected for expansion, but eventually we
-      should think more deeply about which path information to
-      associate with the expanded vs. evaluated nodes in lazy search
-      and where to obtain it from.
+      The predecessor may have been reopened with a lower g value since
+      the state was fetched. Then we cannot use the results computed for
+      the old g value.
     */
-    current_eval_context = EvaluationContext(current_state, current_g, true, &statistics);
+    SearchNode pred_node = search_space.get_node(
+        state_registry.lookup_state(current_predecessor_id));
+    OperatorProxy current_operator = task_proxy.get_operators()[current_operator_id];
+    current_g = pred_node.get_g() + get_adjusted_cost(current_operator);
+    current_real_g = pred_node.get_real_g() + current_operator.get_cost();
+    if (current_g == next.g) {
+        current_eval_context = move(next.eval_context);
+    } else {
+        current_eval_context = EvaluationContext(
+            current_state, current_g, true, &statistics);
+    }
+    pending_states.pop_front();
 
     return IN_PROGRESS;
 }
@@ -216,4 +388,19 @@ void LazySearch::print_statistics() const {
     statistics.print_detailed_statistics();
     search_space.print_statistics();
 }
+
+void add_lookahead_option_to_parser(OptionParser &parser) {
+    parser.add_option<int>(
+        "lookahead",
+        "number of entries that are taken from the open list at once. The "
+        "new states they lead to are evaluated before any of them is "
+        "expanded, and new states with the same predecessor are evaluated "
+        "as a batch, which lets heuristics share work between them (e.g., "
+        "h^add and h^FF). This changes the search order for values larger "
+        "than 1. Heuristics that are used for preferred operators are not "
+        "evaluated in batches. The option has no effect if there are "
+        "path-dependent evaluators.",
+        "1",
+        Bounds("1", "infinity"));
+}
 }
@@ -11,15 +11,53 @@
 
 #include "../utils/rng.h"
 
+#include <deque>
 #include <memory>
 #include <vector>
 
 namespace options {
+class OptionParser;
 class Options;
 }
 
 namespace lazy_search {
 class LazySearch : public SearchEngine {
+    /*
+      A state that has been reached through an entry of the open list but
+      not processed by step() yet.
+    */
+    struct PendingState {
+        StateID predecessor_id;
+        OperatorID operator_id;
+        int g;
+        int real_g;
+        EvaluationContext eval_context;
+        // False if the state is evaluated when it is processed.
+        bool is_evaluated;
+
+        PendingState(StateID predecessor_id, OperatorID operator_id,
+                     int g, int real_g, const EvaluationContext &eval_context)
+            : predecessor_id(predecessor_id), operator_id(operator_id),
+              g(g), real_g(real_g), eval_context(eval_context),
+              is_evaluated(false) {
+        }
+    };
+
+    /*
+      Number of entries that we take from the open list at once. Their new
+      states are evaluated in batches before they are processed.
+    */
+    int lookahead;
+    std::deque<PendingState> pending_states;
+    // Scratch data for evaluate_pending_states.
+    std::vector<EvaluationContext> batch_contexts;
+    std::vector<EvaluationResult> batch_results;
+
+    void fetch_pending_states();
+    void evaluate_pending_states();
+    void evaluate_batch(const State &predecessor, std::size_t begin,
+                        std::size_t end);
+
 protected:
     std::unique_ptr<EdgeOpenList> open_list;
 
@@ -58,6 +96,8 @@ public:
 
     virtual void print_statistics() const override;
 };
+
+extern void add_lookahead_option_to_parser(options::OptionParser &parser);
 }
 
 #endif
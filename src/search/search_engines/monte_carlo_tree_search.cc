@@ -1,49 +1,103 @@
 #include "monte_carlo_tree_search.h"
 
-#include "../open_list_factory.h"
+#include "parallel_search_common.h"
+
 #include "../option_parser.h"
+#include "../option_parser_util.h"
+#include "../plugin.h"
 
-#include "../algorithms/ordered_set.h"
 #include "../task_utils/successor_generator.h"
 #include "../task_utils/task_properties.h"
+#include "../utils/countdown_timer.h"
 #include "../utils/logging.h"
-#include "../utils/rng.h"
+#include "../utils/memory.h"
 #include "../utils/rng_options.h"
-#include "../plugin.h"
 
 #include <algorithm>
-#include <limits.h>
+#include <cassert>
+#include <climits>
+#include <functional>
+#include <limits>
+#include <thread>
 #include <vector>
-#include <cmath>
 
 using namespace std;
 
-
 namespace monte_carlo_tree_search {
-MonteCarloTreeSearch::MonteCarloTreeSearch(const Options &opts)
+/*
+  Orders the backup queue in DAG mode such that the node with the largest
+  state ID is on top, i.e., nodes come before their parents.
+*/
+class BackupQueueOrder {
+    const TreeSearchSpace &space;
+public:
+    explicit BackupQueueOrder(const TreeSearchSpace &space)
+        : space(space) {
+    }
+
+    bool operator()(StateID lhs, StateID rhs) const {
+        return space.is_forward_edge(lhs, rhs);
+    }
+};
+
+static size_t get_memory_budget_in_bytes(const Options &opts) {
+    int budget_in_mb = opts.get<int>("memory_budget");
+    if (budget_in_mb == numeric_limits<int>::max()) {
+        return 0;
+    }
+    return static_cast<size_t>(budget_in_mb) * 1024 * 1024;
+}
+
+MonteCarloTreeSearch::MonteCarloTreeSearch(
+    const Options &opts, const vector<shared_ptr<Evaluator>> &heuristics)
     : SearchEngine(opts),
-    epsilon(opts.get<double>("epsilon")),
-    reopen_closed_nodes(opts.get<bool>("reopen_closed_nodes")),
-    heuristic(opts.get<shared_ptr<Evaluator>>("h")),
-    tree_search_space(state_registry, log)
-    {
-    /*
-      We initialize current_eval_context in such a way that the initial node
-      counts as "preferred".
-    */
+      selection_policy(opts.get<shared_ptr<TreeSelectionPolicy>>("selection")),
+      reopen_closed_nodes(opts.get<bool>("reopen_closed_nodes")),
+      use_dag(opts.get<bool>("dag")),
+      rng(utils::parse_rng_from_options(opts)),
+      num_threads(opts.get<int>("threads")),
+      virtual_loss_weight(opts.get<int>("virtual_loss")),
+      memory_budget(get_memory_budget_in_bytes(opts)),
+      compact_registry(opts.get<bool>("compact_registry")),
+      pruning_threshold(memory_budget),
+      tree_search_space(state_registry, log),
+      worker_status(IN_PROGRESS),
+      tree_statistics(log, opts.get<double>("report_interval")),
+      num_transposition_edges(0),
+      num_lazy_g_corrections(0),
+      num_prunings(0),
+      num_pruned_nodes(0) {
+    assert(static_cast<int>(heuristics.size()) == num_threads);
+    for (const shared_ptr<Evaluator> &heuristic : heuristics) {
+        int seed = rng->random(numeric_limits<int>::max());
+        workers.emplace_back(
+            heuristic, make_shared<utils::RandomNumberGenerator>(seed));
+    }
 }
+
 void MonteCarloTreeSearch::initialize() {
+    log << "Conducting Monte Carlo tree search with " << num_threads
+        << " thread(s), (real) bound = " << bound << endl;
     State initial_state = state_registry.get_initial_state();
     TreeSearchNode init = tree_search_space.get_node(initial_state);
-    EvaluationContext init_eval(initial_state,0,true,&statistics);
-    int h = (init_eval.get_result(heuristic.get())).get_evaluator_value();
+    EvaluationContext init_eval(initial_state, 0, true, &statistics);
+    int h = init_eval.get_result(workers[0].heuristic.get()).get_evaluator_value();
     init.open_initial(h);
+    tree_search_space.add_h_samples(init.get_id(), 1, h);
     statistics.inc_evaluated_states();
+    print_initial_evaluator_values(init_eval, log);
+    tree_statistics.report_h_value(h);
 
+    vector<shared_ptr<Evaluator>> other_heuristics;
+    for (size_t i = 1; i < workers.size(); ++i) {
+        other_heuristics.push_back(workers[i].heuristic);
+    }
+    parallel_search_common::subscribe_evaluators(initial_state, other_heuristics);
 }
 
 bool MonteCarloTreeSearch::check_goal_and_set_plan(const State &state) {
     if (task_properties::is_goal_state(task_proxy, state)) {
+        log << "Solution found!" << endl;
         Plan plan;
         tree_search_space.trace_path(state, plan);
         set_plan(plan);
@@ -52,196 +106,711 @@ bool MonteCarloTreeSearch::check_goal_and_set_plan(const State &state) {
     return false;
 }
 
-State MonteCarloTreeSearch::select_next_leaf_node(const State state){
-    TreeSearchNode node = tree_search_space.get_node(state);
-    assert(!node.is_new() && !node.is_dead_end());
-    if(node.is_open()){
-        return state;
-    }
-    vector<StateID> children = node.get_children();
-    assert(!children.empty());
-    double prob = drand48();
-    bool epsilon_greedy = epsilon >= prob;
-    vector<State> min_state = vector<State>();
-    int min_h = INT_MAX;
-    for(StateID sid : children){
-        State succ_state = state_registry.lookup_state(sid);
-        TreeSearchNode succ_node = tree_search_space.get_node(succ_state);
-        int h = succ_node.get_best_h();
-        if(succ_node.is_dead_end() || h == INT_MAX){
-            continue;
+/*
+  Walk down from the root and return the first open node. At each level,
+  the selection policy chooses among the children that are not dead ends.
+  For the policy, we add the virtual loss of a child times the virtual
+  loss weight to its h values and the virtual loss to its visit count,
+  which steers concurrent workers into different subtrees. Open nodes
+  with virtual loss are expanded or evaluated by another worker and
+  cannot be selected.
+
+  The nodes on the selection path, including the returned leaf, receive
+  virtual loss until release_selection_path is called. If all open nodes
+  that the walk could reach are claimed by other workers, no node gets
+  virtual loss and we return StateID::no_state.
+*/
+StateID MonteCarloTreeSearch::select_next_leaf_node(Worker &worker) {
+    vector<StateID> &path = worker.selection_path;
+    assert(path.empty());
+    StateID current_id = state_registry.get_initial_state().get_id();
+    while (true) {
+        TreeSearchNode node = tree_search_space.get_node(current_id);
+        assert(!node.is_new() && !node.is_dead_end());
+        path.push_back(current_id);
+        if (node.is_open()) {
+            if (tree_search_space.get_virtual_loss(current_id) > 0) {
+                path.clear();
+                return StateID::no_state;
+            }
+            break;
         }
-        if(epsilon_greedy || h == min_h){
-            min_state.push_back(succ_state);
-        }else if(h < min_h){
-            min_h = h;
-            min_state = {succ_state};
+        candidates.clear();
+        for (StateID child_id : node.get_children()) {
+            int h = tree_search_space.get_best_h(child_id);
+            if (tree_search_space.is_dead_end(child_id) || h == INT_MAX) {
+                continue;
+            }
+            int virtual_loss = tree_search_space.get_virtual_loss(child_id);
+            if (virtual_loss > 0 && tree_search_space.is_open(child_id)) {
+                continue;
+            }
+            int penalty = virtual_loss_weight * virtual_loss;
+            candidates.emplace_back(
+                child_id, h + penalty,
+                tree_search_space.get_average_h(child_id) + penalty,
+                tree_search_space.get_num_visits(child_id) + virtual_loss);
+        }
+        if (candidates.empty()) {
+            // All children that are not dead ends are claimed.
+            assert(num_threads > 1);
+            path.clear();
+            return StateID::no_state;
         }
+        int parent_visits = tree_search_space.get_num_visits(current_id) +
+            tree_search_space.get_virtual_loss(current_id);
+        int index = selection_policy->choose_child(
+            candidates, parent_visits, *worker.rng);
+        current_id = candidates[index].id;
+        if (use_dag) {
+            correct_g_lazily(node, current_id);
+        }
+    }
+
+    for (StateID id : path) {
+        tree_search_space.add_virtual_loss(id, 1);
     }
-    assert(!min_state.empty());
-    State succ = min_state.at(rand() % min_state.size());
-    return select_next_leaf_node(succ);
+    tree_statistics.inc_iterations(path.size() - 1);
+    return current_id;
 }
 
-SearchStatus MonteCarloTreeSearch::expand_tree(const State state){
-    TreeSearchNode node = tree_search_space.get_node(state);
-    if(node.is_dead_end() || node.is_closed() || node.is_new()){
-        exit(228);
+void MonteCarloTreeSearch::release_selection_path(Worker &worker) {
+    for (StateID id : worker.selection_path) {
+        tree_search_space.add_virtual_loss(id, -1);
     }
+    worker.selection_path.clear();
+}
+
+/*
+  Close the given leaf and add its successors to the tree. New successors
+  are not evaluated here but collected in the pending children of the
+  worker. Until they are evaluated, they inherit the h value of the leaf
+  and their virtual loss keeps other workers from selecting them.
+*/
+SearchStatus MonteCarloTreeSearch::expand_tree(Worker &worker, StateID leaf_id) {
+    TreeSearchNode node = tree_search_space.get_node(leaf_id);
+    assert(node.is_open());
+    State state = node.get_state();
+    worker.expanded_state = utils::make_unique_ptr<State>(state);
     node.close();
     statistics.inc_expanded();
+
     vector<OperatorID> successor_operators;
-    successor_generator.generate_applicable_ops(
-    state, successor_operators);
-    if(successor_operators.empty()){
-        //cout << "mark:" << state.get_id() << endl;
-        node.mark_as_dead_end();
-        node.set_best_h(INT_MAX);
-        statistics.inc_dead_ends();
-        return IN_PROGRESS;
-    }
-    bool no_addition = true;
-    /*
-    vector<StateID> all_succs = {};
-    for (OperatorID op_id : successor_operators) { 
-        OperatorProxy op = task_proxy.get_operators()[op_id];
-        State succ_state = state_registry.get_successor_state(state, op);
-        StateID succ_id = succ_state.get_id();
-        all_succs.push_back(succ_id);
-    }*/
-    
-    //cout << "successors:" <<all_succs << endl;
+    successor_generator.generate_applicable_ops(state, successor_operators);
+    statistics.inc_generated_ops(successor_operators.size());
+
+    int num_new_children = 0;
     for (OperatorID op_id : successor_operators) {
-        statistics.inc_generated();
         OperatorProxy op = task_proxy.get_operators()[op_id];
+        if (node.get_real_g() + op.get_cost() >= bound)
+            continue;
+
         State succ_state = state_registry.get_successor_state(state, op);
+        statistics.inc_generated();
         TreeSearchNode succ_node = tree_search_space.get_node(succ_state);
         StateID succ_id = succ_state.get_id();
-        int succ_g = succ_node.get_real_g();
-        int succ_h;
-        if(succ_node.is_new()){
-            //cout << "new_succ_id: " << succ_id << endl;
-            no_addition = false;
+
+        if (succ_node.is_new()) {
+            ++num_new_children;
             node.add_child(succ_id);
-            EvaluationContext succ_eval_context(
-            succ_state, succ_g, true, &statistics);
-            statistics.inc_evaluated_states();
-            int h  = succ_eval_context.get_result(heuristic.get()).get_evaluator_value();
-            succ_node.open(node, op, get_adjusted_cost(op), h);
-            if(h >= bound){
-                succ_node.mark_as_dead_end();
-                succ_node.set_best_h(INT_MAX);
+            int succ_g = node.get_g() + get_adjusted_cost(op);
+            succ_node.open(node, op, get_adjusted_cost(op), node.get_best_h());
+            tree_search_space.add_virtual_loss(succ_id, 1);
+            /*
+              The child is evaluated after other states have been
+              registered, possibly by other threads. By then, the data
+              that succ_state points to may have been compressed and
+              freed (see state_registry.h), so we store a state that owns
+              its data in that case.
+            */
+            worker.pending_children.emplace_back(
+                state_registry.lookup_state(succ_id), succ_g);
+        } else if (use_dag) {
+            if (!succ_node.is_dead_end() &&
+                tree_search_space.is_forward_edge(leaf_id, succ_id) &&
+                node.add_child(succ_id)) {
+                ++num_new_children;
+                add_transposition_edge(node, succ_node, op);
             }
-        }else if(succ_node.is_closed() && reopen_closed_nodes){
+        } else if (succ_node.is_closed() && reopen_closed_nodes) {
+            int succ_g = succ_node.get_real_g();
             int new_succ_g = node.get_real_g() + op.get_cost();
-            if(new_succ_g < succ_g){
+            if (new_succ_g < succ_g) {
+                /*
+                  Move the subtree rooted at the successor below the
+                  current node. The old parent may have lost its best
+                  child, so its best_h has to be backed up again, and the
+                  g values of the whole subtree decrease.
+                */
                 statistics.inc_reopened();
+                ++num_new_children;
+                StateID old_parent_id = succ_node.get_parent();
+                tree_search_space.get_node(old_parent_id).remove_child(succ_id);
                 node.add_child(succ_id);
-                succ_node.update_g(succ_g - new_succ_g);
-                State previous_parent = state_registry.lookup_state(succ_node.get_parent());
-                TreeSearchNode pred_node = tree_search_space.get_node(previous_parent);//previous parent node
-                State current_parent = node.get_state();//new parent node
-                StateID curr_id = succ_node.get_state().get_id();
-                pred_node.remove_child(curr_id);//remove child from old parent
-                back_propagate(previous_parent);//We bp this because it might now contain a dead-end/higher best-h
-                succ_node.reopen(node,op,get_adjusted_cost(op));
-                reopen_g(succ_state,succ_g - new_succ_g); // recursive g_update
+                succ_node.update_parent(node, op, get_adjusted_cost(op));
+                back_propagate(old_parent_id, 0, 0);
+                forward_propagate_g(succ_id, succ_g - new_succ_g);
             }
         }
-        if(check_goal_and_set_plan(succ_state)){
+        if (check_goal_and_set_plan(succ_state)) {
             return SOLVED;
         }
     }
-    //cout << "children: "<< node.get_children() << endl;
-    if(no_addition){
+    tree_statistics.report_expansion(
+        successor_operators.size(), num_new_children);
+    if (num_new_children == 0) {
         node.mark_as_dead_end();
+        node.set_best_h(INT_MAX);
+        statistics.inc_dead_ends();
     }
     return IN_PROGRESS;
 }
 
-void MonteCarloTreeSearch::forward_propagate_g(State state,int g_diff){
-    TreeSearchNode node = tree_search_space.get_node(state);
-    if(node.is_dead_end() || node.is_open())
+/*
+  Evaluate the pending children of the given worker with its own
+  heuristic in one batch, so that the heuristic can share work between
+  them. This is called without holding the tree lock, so it must not
+  access the tree search space, the registry or the statistics.
+*/
+void MonteCarloTreeSearch::evaluate_pending_children(Worker &worker) {
+    if (worker.pending_children.empty()) {
+        return;
+    }
+    worker.eval_contexts.clear();
+    for (const PendingChild &child : worker.pending_children) {
+        worker.eval_contexts.emplace_back(child.state, child.g, true, nullptr);
+    }
+    worker.heuristic->compute_successor_results(
+        *worker.expanded_state, worker.eval_contexts, worker.eval_results);
+    for (size_t i = 0; i < worker.pending_children.size(); ++i) {
+        const EvaluationResult &result = worker.eval_results[i];
+        worker.pending_children[i].h = result.get_evaluator_value();
+        if (result.get_count_evaluation()) {
+            ++worker.num_evaluations;
+        }
+    }
+}
+
+/*
+  Store the h values of the evaluated children of the given worker in the
+  tree, release their virtual loss and back up the results from the given
+  leaf, whose children they are.
+*/
+void MonteCarloTreeSearch::insert_evaluated_children(
+    Worker &worker, StateID leaf_id) {
+    int num_samples = 0;
+    double sum_h = 0;
+    for (const PendingChild &child : worker.pending_children) {
+        StateID child_id = child.state.get_id();
+        TreeSearchNode child_node = tree_search_space.get_node(child_id);
+        assert(child_node.is_open());
+        tree_search_space.add_virtual_loss(child_id, -1);
+        child_node.set_best_h(child.h);
+        if (child.h >= bound) {
+            child_node.mark_as_dead_end();
+            child_node.set_best_h(INT_MAX);
+            statistics.inc_dead_ends();
+        } else {
+            tree_search_space.add_h_samples(child_id, 1, child.h);
+            tree_statistics.report_h_value(child.h);
+            ++num_samples;
+            sum_h += child.h;
+        }
+    }
+    if (use_dag) {
+        /*
+          Children that were generated by this worker may have received
+          further parents through transpositions while they were evaluated.
+        */
+        for (const PendingChild &child : worker.pending_children) {
+            for (StateID parent_id :
+                 tree_search_space.get_extra_parents(child.state.get_id())) {
+                push_to_backup_queue(parent_id);
+            }
+        }
+    }
+    back_propagate(leaf_id, num_samples, sum_h);
+    statistics.inc_evaluated_states(worker.pending_children.size());
+    statistics.inc_evaluations(worker.num_evaluations);
+    worker.num_evaluations = 0;
+    worker.pending_children.clear();
+}
+
+/*
+  Decrease the real g values of all descendants of the given node by
+  g_diff. The subtree is traversed with an explicit stack.
+*/
+void MonteCarloTreeSearch::forward_propagate_g(StateID state_id, int g_diff) {
+    assert(g_propagation_stack.empty());
+    g_propagation_stack.push_back(state_id);
+    while (!g_propagation_stack.empty()) {
+        StateID id = g_propagation_stack.back();
+        g_propagation_stack.pop_back();
+        TreeSearchNode node = tree_search_space.get_node(id);
+        if (node.is_dead_end() || node.is_open())
+            continue;
+        for (StateID child_id : node.get_children()) {
+            tree_search_space.get_node(child_id).update_g(g_diff);
+            g_propagation_stack.push_back(child_id);
+        }
+    }
+}
+
+/*
+  In DAG mode, a transposition becomes an additional edge from the given
+  node to its successor instead of moving the subtree of the successor.
+  If the new edge lies on a cheaper path, it becomes the primary edge of
+  the successor and the old primary parent becomes an extra parent. The g
+  values of the descendants of the successor are not updated here but
+  corrected lazily when selection walks down to them.
+*/
+void MonteCarloTreeSearch::add_transposition_edge(
+    TreeSearchNode &node, TreeSearchNode &succ_node, const OperatorProxy &op) {
+    ++num_transposition_edges;
+    int new_succ_g = node.get_real_g() + op.get_cost();
+    if (new_succ_g < succ_node.get_real_g()) {
+        statistics.inc_reopened();
+        StateID old_parent_id = succ_node.get_parent();
+        succ_node.update_parent(node, op, get_adjusted_cost(op));
+        succ_node.add_extra_parent(old_parent_id);
+    } else {
+        succ_node.add_extra_parent(node.get_id());
+    }
+}
+
+/*
+  Make the g value of the given child consistent with the given parent if
+  the parent is its primary parent. Since selection starts at the root,
+  whose g value never changes, the g values on a selection path that only
+  follows primary edges are exact. Nodes that are reached via an extra
+  parent keep their g value until they are reached via their primary
+  parent, so in DAG mode g values can be too high, but never too low.
+*/
+void MonteCarloTreeSearch::correct_g_lazily(
+    const TreeSearchNode &parent_node, StateID child_id) {
+    if (tree_search_space.get_parent(child_id) != parent_node.get_id()) {
         return;
-    for(StateID s : node.get_children()){
-        State c_state = state_registry.lookup_state(s);
-        TreeSearchNode c_node = tree_search_space.get_node(c_state);
-        c_node.update_g(g_diff);
-        reopen_g(c_state,g_diff);
+    }
+    TreeSearchNode child_node = tree_search_space.get_node(child_id);
+    OperatorProxy op = task_proxy.get_operators()[child_node.get_operator()];
+    if (child_node.get_real_g() != parent_node.get_real_g() + op.get_cost()) {
+        child_node.update_parent(parent_node, op, get_adjusted_cost(op));
+        ++num_lazy_g_corrections;
     }
 }
 
-void MonteCarloTreeSearch::back_propagate_dead_end(State state){
-    TreeSearchNode node = tree_search_space.get_node(state);
-    bool dead_end = true;
+/*
+  Recompute best_h of the given node from its children and mark it as a
+  dead end if all children are dead ends. Returns true iff best_h of the
+  node changed.
+*/
+bool MonteCarloTreeSearch::update_best_h(TreeSearchNode &node) {
     int min_h = INT_MAX;
-    for (StateID child : node.get_children()) {
-        State child_state = state_registry.lookup_state(child);
-        TreeSearchNode child_node = tree_search_space.get_node(child_state);
-        int h_child = child_node.get_best_h();
-        if(child_node.is_dead_end() && (h_child == INT_MAX)){
+    if (!node.is_dead_end()) {
+        assert(node.is_closed());
+        for (StateID child_id : node.get_children()) {
+            if (!tree_search_space.is_dead_end(child_id)) {
+                min_h = min(min_h, tree_search_space.get_best_h(child_id));
+            }
+        }
+        if (min_h == INT_MAX) {
+            node.mark_as_dead_end();
+            statistics.inc_dead_ends();
+        }
+    }
+    if (node.get_best_h() == min_h) {
+        return false;
+    }
+    node.set_best_h(min_h);
+    return true;
+}
+
+/*
+  Back up best_h values from the given node towards the root and add the
+  given number of new h samples with the given sum to the selection
+  statistics of the node and its ancestors, all in one pass. Since the
+  given node itself may have changed without its best_h changing (e.g.,
+  after it was closed), we always continue with its parent. Without new
+  samples, we stop at the first ancestor whose best_h remains unchanged.
+
+  When a subtree is moved to a new parent because a cheaper path to its
+  root was found, its samples stay in the statistics of the old
+  ancestors.
+*/
+void MonteCarloTreeSearch::back_propagate(
+    StateID state_id, int num_samples, double sum_h) {
+    if (use_dag) {
+        /*
+          The new samples are only added along the primary parents, so
+          that every ancestor counts them at most once.
+        */
+        for (StateID id = state_id; id != StateID::no_state;
+             id = tree_search_space.get_parent(id)) {
+            tree_search_space.add_h_samples(id, num_samples, sum_h);
+        }
+        push_to_backup_queue(state_id);
+        process_backup_queue();
+        return;
+    }
+    TreeSearchNode node = tree_search_space.get_node(state_id);
+    update_best_h(node);
+    tree_search_space.add_h_samples(state_id, num_samples, sum_h);
+    bool best_h_changed = true;
+    StateID parent_id = node.get_parent();
+    while (parent_id != StateID::no_state &&
+           (best_h_changed || num_samples > 0)) {
+        TreeSearchNode parent_node = tree_search_space.get_node(parent_id);
+        if (best_h_changed) {
+            best_h_changed = update_best_h(parent_node);
+        }
+        tree_search_space.add_h_samples(parent_id, num_samples, sum_h);
+        parent_id = parent_node.get_parent();
+    }
+}
+
+void MonteCarloTreeSearch::push_to_backup_queue(StateID state_id) {
+    backup_queue.push_back(state_id);
+    push_heap(backup_queue.begin(), backup_queue.end(),
+              BackupQueueOrder(tree_search_space));
+}
+
+/*
+  Back up best_h values in DAG mode. A node can have several parents, so
+  a changed best_h has to be propagated along all incoming edges. We
+  process the queued nodes in decreasing order of their state IDs. Since
+  all edges lead to larger IDs, all children of a node have been updated
+  when it is processed, so every node is updated at most once. The parents
+  of a node are only queued if its best_h changed.
+*/
+void MonteCarloTreeSearch::process_backup_queue() {
+    StateID last_id = StateID::no_state;
+    while (!backup_queue.empty()) {
+        pop_heap(backup_queue.begin(), backup_queue.end(),
+                 BackupQueueOrder(tree_search_space));
+        StateID id = backup_queue.back();
+        backup_queue.pop_back();
+        // Duplicates leave the heap one after another.
+        if (id == last_id) {
+            continue;
+        }
+        last_id = id;
+        TreeSearchNode node = tree_search_space.get_node(id);
+        if (!update_best_h(node)) {
             continue;
         }
-        if(h_child < min_h)
-            min_h = h_child;
-        dead_end = false;
+        StateID parent_id = node.get_parent();
+        if (parent_id != StateID::no_state) {
+            push_to_backup_queue(parent_id);
+        }
+        for (StateID extra_parent_id : node.get_extra_parents()) {
+            push_to_backup_queue(extra_parent_id);
+        }
     }
-    if(dead_end && !node.is_dead_end()) {
-        assert(min_h == INT_MAX);
-        //cout << "mark bp:" << state.get_id();
-        node.mark_as_dead_end();
-        node.set_best_h(min_h);
-        statistics.inc_dead_ends();
-    }else{
-        int curr_h = node.get_best_h();
-        if(curr_h == min_h){
-            return;
+}
+
+size_t MonteCarloTreeSearch::estimate_memory_in_bytes() const {
+    return tree_search_space.estimate_memory_in_bytes() +
+           state_registry.estimate_memory_in_bytes();
+}
+
+/*
+  Free memory when the memory budget is reached. We first collapse the
+  subtrees below dead ends, which are never selected again, and then the
+  subtrees of closed nodes in decreasing order of best_h until at most
+  half of the nodes remain. Collapsed nodes become open leaves that can
+  be expanded again later. Nodes with virtual loss are on the selection
+  path of a worker or are evaluated by one, so their subtrees are kept.
+
+  If pruning does not get the estimate below the budget (e.g., because
+  the state registry is not compacted), the next pruning happens when the
+  estimate has grown by another quarter of the budget.
+*/
+void MonteCarloTreeSearch::prune_tree() {
+    size_t memory_before = estimate_memory_in_bytes();
+    size_t num_nodes = tree_search_space.count_nodes();
+    size_t max_remaining_nodes = num_nodes / 2;
+    StateID root_id = state_registry.get_initial_state().get_id();
+
+    size_t num_removed = 0;
+    pruning_candidates.clear();
+    for (StateID id : state_registry) {
+        TreeSearchNode node = tree_search_space.get_node(id);
+        if (id == root_id || node.get_children().empty() ||
+            tree_search_space.get_virtual_loss(id) > 0) {
+            continue;
+        }
+        if (node.is_dead_end()) {
+            num_removed += tree_search_space.collapse(id);
+        } else if (node.is_closed()) {
+            pruning_candidates.push_back(id);
+        }
+    }
+
+    /*
+      Descendants have at least the best_h of their ancestors, so deeper
+      subtrees tend to be collapsed before the subtrees that contain them.
+    */
+    sort(pruning_candidates.begin(), pruning_candidates.end(),
+         [this](StateID lhs, StateID rhs) {
+             int lhs_h = tree_search_space.get_best_h(lhs);
+             int rhs_h = tree_search_space.get_best_h(rhs);
+             if (lhs_h != rhs_h) {
+                 return lhs_h > rhs_h;
+             }
+             return tree_search_space.is_forward_edge(rhs, lhs);
+         });
+    for (StateID id : pruning_candidates) {
+        if (num_nodes - num_removed <= max_remaining_nodes) {
+            break;
+        }
+        // The node may have been removed with the subtree of another node.
+        if (tree_search_space.get_node(id).is_closed()) {
+            num_removed += tree_search_space.collapse(id);
         }
-        assert(min_h != INT_MAX);
-        node.set_best_h(min_h);
     }
-    StateID pred_id = node.get_parent();
-    OperatorID pred_op = node.get_operator();
-    if(pred_id != StateID::no_state && pred_op != OperatorID::no_operator){
-        State pred = state_registry.lookup_state(pred_id);
-        back_propagate(pred);
-    }   
+    pruning_candidates.clear();
+
+    tree_search_space.compact(compact_registry);
+    ++num_prunings;
+    num_pruned_nodes += num_removed;
+
+    size_t memory_after = estimate_memory_in_bytes();
+    pruning_threshold = max(memory_budget, memory_after + memory_budget / 4);
+    log << "Pruned " << num_removed << " of " << num_nodes
+        << " tree nodes, estimated memory: " << memory_before / 1024
+        << " KB -> " << memory_after / 1024 << " KB" << endl;
+    if (memory_after >= memory_budget) {
+        log << "Pruning could not reduce the estimated memory below the "
+            << "memory budget." << endl;
+    }
+}
+
+/*
+  Run one iteration (selection, expansion, evaluation and back-propagation)
+  with the given worker. The tree lock is released while the new children
+  are evaluated, so that other workers can run their iterations in the
+  meantime.
+*/
+SearchStatus MonteCarloTreeSearch::run_iteration(Worker &worker) {
+    TreeSearchStatistics::Clock::time_point phase_start =
+        TreeSearchStatistics::Clock::now();
+    unique_lock<mutex> lock(tree_mutex);
+    tree_statistics.add_phase_time(
+        TreeSearchStatistics::LOCK_WAIT, TreeSearchStatistics::lap(phase_start));
+    if (worker_status != IN_PROGRESS) {
+        return worker_status;
+    }
+    const State &initial_state = state_registry.get_initial_state();
+    if (tree_search_space.get_node(initial_state).is_dead_end()) {
+        log << "Completely explored state space -- no solution!" << endl;
+        worker_status = FAILED;
+        return worker_status;
+    }
+    if (tree_statistics.is_report_due()) {
+        tree_statistics.print_progress_line(
+            tree_search_space.estimate_memory_in_bytes());
+    }
+    if (memory_budget > 0 && estimate_memory_in_bytes() >= pruning_threshold) {
+        prune_tree();
+    }
+    TreeSearchStatistics::lap(phase_start);
+
+    StateID leaf_id = select_next_leaf_node(worker);
+    tree_statistics.add_phase_time(
+        TreeSearchStatistics::SELECTION, TreeSearchStatistics::lap(phase_start));
+    if (leaf_id == StateID::no_state) {
+        tree_statistics.inc_selection_collisions();
+        lock.unlock();
+        this_thread::yield();
+        return IN_PROGRESS;
+    }
+    if (expand_tree(worker, leaf_id) == SOLVED) {
+        // The search ends here, so we do not release the virtual loss.
+        worker_status = SOLVED;
+        return worker_status;
+    }
+    tree_statistics.add_phase_time(
+        TreeSearchStatistics::EXPANSION, TreeSearchStatistics::lap(phase_start));
+
+    lock.unlock();
+    evaluate_pending_children(worker);
+    double evaluation_time = TreeSearchStatistics::lap(phase_start);
+    lock.lock();
+    tree_statistics.add_phase_time(
+        TreeSearchStatistics::EVALUATION, evaluation_time);
+    tree_statistics.add_phase_time(
+        TreeSearchStatistics::LOCK_WAIT, TreeSearchStatistics::lap(phase_start));
+
+    insert_evaluated_children(worker, leaf_id);
+    release_selection_path(worker);
+    tree_statistics.add_phase_time(
+        TreeSearchStatistics::BACKUP, TreeSearchStatistics::lap(phase_start));
+    return IN_PROGRESS;
 }
 
+void MonteCarloTreeSearch::run_worker(
+    Worker &worker, const utils::CountdownTimer &timer) {
+    while (run_iteration(worker) == IN_PROGRESS && !timer.is_expired() &&
+           !is_stop_requested()) {
+    }
+}
 
+/*
+  With a single thread, every step is one iteration. Otherwise, a single
+  step runs all worker threads until one of them solves the task or
+  proves it unsolvable, or until the time limit is reached.
+*/
 SearchStatus MonteCarloTreeSearch::step() {
-    State init = state_registry.get_initial_state();
-    TreeSearchNode init_node = tree_search_space.get_node(init);
-    if(init_node.is_dead_end()){
-        return FAILED;
-    State leaf = select_next_leaf_node(init);
-    //cout << "leaf:" << leaf.get_id() << endl;
-    SearchStatus status = expand_tree(leaf);
-    back_propagate(leaf);
-    return status;
+    if (num_threads == 1) {
+        return run_iteration(workers[0]);
+    }
+
+    utils::CountdownTimer timer(max_time);
+    vector<thread> threads;
+    for (int i = 1; i < num_threads; ++i) {
+        threads.emplace_back(&MonteCarloTreeSearch::run_worker, this,
+                             ref(workers[i]), cref(timer));
+    }
+    run_worker(workers[0], timer);
+    for (thread &worker_thread : threads) {
+        worker_thread.join();
+    }
+    /*
+      If the time limit was reached, the status is still IN_PROGRESS and
+      SearchEngine::search() reports the timeout.
+    */
+    return worker_status;
 }
 
 void MonteCarloTreeSearch::print_statistics() const {
     statistics.print_detailed_statistics();
+    tree_statistics.print_detailed_statistics();
+    if (use_dag) {
+        log << "Transposition edges: " << num_transposition_edges << endl;
+        log << "Lazy g corrections: " << num_lazy_g_corrections << endl;
+    }
+    if (memory_budget > 0) {
+        log << "Tree prunings: " << num_prunings << endl;
+        log << "Pruned tree nodes: " << num_pruned_nodes << endl;
+    }
     tree_search_space.print_statistics();
 }
+
 static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
     parser.document_synopsis("Monte carlo tree search", "");
+    parser.document_note(
+        "Parallel search",
+        "With threads > 1, all threads run iterations on the same tree. "
+        "Selection, expansion and back-propagation are serialized by a "
+        "lock, while the heuristic values of new nodes are computed "
+        "concurrently. Every thread has its own copy of the heuristic, "
+        "so the heuristic must be defined inline rather than predefined "
+        "with --evaluator. Nodes that are selected by a thread receive a "
+        "virtual loss until the thread has backed up its result, which "
+        "makes concurrent threads prefer different subtrees.");
+    parser.document_note(
+        "Random numbers",
+        "Every thread uses its own random number generator, which is "
+        "seeded from the random number generator given by random_seed. "
+        "With a single thread, runs with the same random_seed are "
+        "reproducible. With several threads, the order in which the "
+        "threads access the tree still depends on the scheduler.");
 
-    parser.add_option<shared_ptr<Evaluator>>(
+    parser.document_note(
+        "DAG mode",
+        "With dag=true, the search builds a directed acyclic graph instead "
+        "of a tree. When an expansion generates a state that is already "
+        "in the graph, it adds an edge to it instead of ignoring it or "
+        "moving its subtree (reopen_closed_nodes is ignored). To keep the "
+        "graph acyclic, only edges to states with a larger state ID are "
+        "added. best_h values are backed up along all parents, while the "
+        "visit counts and average h values used by the selection policy "
+        "are only updated along the cheapest known path. If a cheaper path "
+        "to a node is found, the g values of its descendants are corrected "
+        "when selection walks down to them.");
+
+    parser.document_note(
+        "Memory budget",
+        "With a memory budget, the search prunes the tree whenever the "
+        "estimated memory of the tree and the state registry reaches the "
+        "budget: it removes the subtrees below dead ends and the subtrees "
+        "with the highest best h values until at most half of the nodes "
+        "remain. The roots of removed subtrees become leaves that can be "
+        "expanded again. Removed states stay in the state registry unless "
+        "compact_registry=true, which renumbers the remaining states and "
+        "discards all per-state information of the heuristics, such as "
+        "cached heuristic values. This is only safe for heuristics that "
+        "do not rely on per-state information to compute correct values "
+        "(unlike, e.g., the landmark count heuristic). Memory used by the "
+        "heuristics is not included in the estimate. Memory budgets are "
+        "not supported in DAG mode.");
+
+    parser.add_option<ParseTree>(
         "h",
         "set heuristic.");
 
-    parser.add_option<double>("epsilon",
-                         "Epsilon", "0.001");
+    parser.add_option<shared_ptr<TreeSelectionPolicy>>(
+        "selection",
+        "policy for choosing the child to descend to during selection",
+        "epsilon_greedy_selection()");
     parser.add_option<bool>("reopen_closed_nodes",
-                         "Reopen", "false");
+                            "Reopen", "false");
+    parser.add_option<bool>(
+        "dag",
+        "add edges to states that are already in the search graph "
+        "(see the note on DAG mode)",
+        "false");
+    parallel_search_common::add_threads_option_to_parser(parser);
+    parser.add_option<int>(
+        "virtual_loss",
+        "amount that is added to the best h value of a node during "
+        "selection for every thread that currently has the node on its "
+        "selection path",
+        "1",
+        Bounds("0", "infinity"));
+    parser.add_option<int>(
+        "memory_budget",
+        "memory budget for the tree and the state registry in MiB "
+        "(see the note on memory budgets)",
+        "infinity",
+        Bounds("1", "infinity"));
+    parser.add_option<bool>(
+        "compact_registry",
+        "remove states that were pruned from the tree from the state "
+        "registry (only with threads=1)",
+        "false");
+    parser.add_option<double>(
+        "report_interval",
+        "print a progress line with the number of iterations per second, "
+        "the average selection depth, the branching factor, the best h "
+        "value, the memory of the tree and the fractions of time spent in "
+        "the phases of an iteration at this interval (in seconds)",
+        "10",
+        Bounds("0", "infinity"));
+    utils::add_rng_options(parser);
     SearchEngine::add_options_to_parser(parser);
     Options opts = parser.parse();
 
+    if (parser.help_mode()) {
+        return nullptr;
+    }
+
+    if (opts.get<int>("memory_budget") != numeric_limits<int>::max() &&
+        opts.get<bool>("dag")) {
+        parser.error("memory_budget is not supported with dag=true");
+    }
+    if (opts.get<bool>("compact_registry") && opts.get<int>("threads") > 1) {
+        parser.error("compact_registry requires threads=1");
+    }
+
+    vector<shared_ptr<Evaluator>> heuristics =
+        parallel_search_common::create_evaluators_for_threads(
+            parser, opts.get<ParseTree>("h"), opts.get<int>("threads"));
+
     shared_ptr<monte_carlo_tree_search::MonteCarloTreeSearch> engine;
     if (!parser.dry_run()) {
-        engine = make_shared<monte_carlo_tree_search::MonteCarloTreeSearch>(opts);
+        engine = make_shared<monte_carlo_tree_search::MonteCarloTreeSearch>(
+            opts, heuristics);
     }
 
     return engine;
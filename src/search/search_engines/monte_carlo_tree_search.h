@@ -8,48 +8,140 @@
 #include "../search_engine.h"
 #include "../search_progress.h"
 #include "../search_space.h"
+#include "../tree_selection_policy.h"
 #include "../treesearch_space.h"
+#include "../treesearch_statistics.h"
 
 #include "../utils/rng.h"
-#include <queue>
 
+#include <cstddef>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace options {
 class Options;
 }
 
+namespace utils {
+class CountdownTimer;
+}
+
 namespace monte_carlo_tree_search {
 class MonteCarloTreeSearch : public SearchEngine {
+    /*
+      A successor that was added to the tree by an expansion but has not
+      been evaluated yet. Evaluation happens after the tree lock has been
+      released, so the state must come from StateRegistry::lookup_state.
+    */
+    struct PendingChild {
+        State state;
+        int g;
+        int h;
+
+        PendingChild(const State &state, int g)
+            : state(state), g(g), h(-1) {
+        }
+    };
+
+    /*
+      Data of one worker thread. Evaluators are not thread-safe, so every
+      worker has its own heuristic object. Every worker also draws from
+      its own random number generator, which is seeded from the random
+      number generator of the engine.
+    */
+    struct Worker {
+        std::shared_ptr<Evaluator> heuristic;
+        std::shared_ptr<utils::RandomNumberGenerator> rng;
+        std::vector<StateID> selection_path;
+        std::vector<PendingChild> pending_children;
+        // The state whose successors are pending.
+        std::unique_ptr<State> expanded_state;
+        std::vector<EvaluationContext> eval_contexts;
+        std::vector<EvaluationResult> eval_results;
+        int num_evaluations;
+
+        Worker(const std::shared_ptr<Evaluator> &heuristic,
+               const std::shared_ptr<utils::RandomNumberGenerator> &rng)
+            : heuristic(heuristic), rng(rng), num_evaluations(0) {
+        }
+    };
 protected:
     // Search behavior parameters
-    double epsilon;
+    std::shared_ptr<TreeSelectionPolicy> selection_policy;
     bool reopen_closed_nodes; // whether to reopen closed nodes upon finding lower g paths
+    bool use_dag; // whether to add transpositions as edges instead of moving subtrees
     bool randomize_successors;
     bool preferred_successors_first;
     std::shared_ptr<utils::RandomNumberGenerator> rng;
 
-    std::shared_ptr<Evaluator> heuristic;
+    int num_threads;
+    int virtual_loss_weight;
+
+    // Memory budget for the tree and the state registry (0 = no budget).
+    std::size_t memory_budget;
+    bool compact_registry;
+    // The tree is pruned when the estimated memory reaches this value.
+    std::size_t pruning_threshold;
+
+    std::vector<Worker> workers;
 
     TreeSearchSpace tree_search_space;
-    bool check_goal_and_set_plan(const State &state);
-public:
+
+    /*
+      Guards the tree search space, the state registry, the statistics
+      and the plan. Workers only release it while they evaluate states.
+    */
+    std::mutex tree_mutex;
+    // Set by the first worker that solves the task or proves it unsolvable.
+    SearchStatus worker_status;
+
+    /*
+      Scratch buffers that are reused in every iteration so that selection
+      and g propagation do not allocate memory. They are only used while
+      holding the tree lock.
+    */
+    std::vector<SelectionCandidate> candidates;
+    std::vector<StateID> g_propagation_stack;
+    // Max-heap of state IDs whose best_h has to be recomputed in DAG mode.
+    std::vector<StateID> backup_queue;
+    std::vector<StateID> pruning_candidates;
+
+    // Statistics
+    TreeSearchStatistics tree_statistics;
+    int num_transposition_edges;
+    int num_lazy_g_corrections;
+    int num_prunings;
+    long long num_pruned_nodes;
+
+    virtual bool check_goal_and_set_plan(const State &state) override;
+
+    StateID select_next_leaf_node(Worker &worker);
+    SearchStatus expand_tree(Worker &worker, StateID leaf_id);
+    void evaluate_pending_children(Worker &worker);
+    void insert_evaluated_children(Worker &worker, StateID leaf_id);
+    void release_selection_path(Worker &worker);
+    bool update_best_h(TreeSearchNode &node);
+    void back_propagate(StateID state_id, int num_samples, double sum_h);
+    void forward_propagate_g(StateID state_id, int g_diff);
+    void add_transposition_edge(
+        TreeSearchNode &node, TreeSearchNode &succ_node, const OperatorProxy &op);
+    void correct_g_lazily(const TreeSearchNode &parent_node, StateID child_id);
+    void push_to_backup_queue(StateID state_id);
+    void process_backup_queue();
+
+    std::size_t estimate_memory_in_bytes() const;
+    void prune_tree();
+
+    SearchStatus run_iteration(Worker &worker);
+    void run_worker(Worker &worker, const utils::CountdownTimer &timer);
 
     virtual void initialize() override;
     virtual SearchStatus step() override;
-    State select_next_leaf_node(const State state);
-    SearchStatus expand_tree(const State state);
-    void back_propagate(State state);
-    void back_propagate_dead_end(State state);
-    void re_back_propagate_best_h(State state);
-    void back_propagate_best_h(State state);
-    void forward_propagate_g(State state, int g_diff);
-
-    std::vector<OperatorID> get_successor_operators(
-        const ordered_set::OrderedSet<OperatorID> &preferred_operators) const;
-
-    explicit MonteCarloTreeSearch(const options::Options &opts);
+public:
+    MonteCarloTreeSearch(
+        const options::Options &opts,
+        const std::vector<std::shared_ptr<Evaluator>> &heuristics);
     virtual ~MonteCarloTreeSearch() = default;
 
     virtual void print_statistics() const override;
@@ -0,0 +1,295 @@
+#include "parallel_greedy_search.h"
+
+#include "parallel_search_common.h"
+
+#include "../evaluation_context.h"
+#include "../evaluator.h"
+#include "../option_parser.h"
+#include "../option_parser_util.h"
+#include "../plugin.h"
+
+#include "../task_utils/successor_generator.h"
+#include "../task_utils/task_properties.h"
+#include "../utils/countdown_timer.h"
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/rng_options.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <set>
+#include <thread>
+
+using namespace std;
+
+namespace parallel_greedy_search {
+ParallelGreedySearch::Worker::Worker(
+    const shared_ptr<Evaluator> &evaluator, int seed, utils::LogProxy &log)
+    : evaluator(evaluator),
+      rng(seed),
+      statistics(log) {
+}
+
+ParallelGreedySearch::ParallelGreedySearch(
+    const Options &opts, const vector<shared_ptr<Evaluator>> &evaluators)
+    : SearchEngine(opts),
+      num_threads(opts.get<int>("threads")),
+      shared_registry(task_proxy, true, opts.get<bool>("zobrist_hashing")),
+      search_nodes(shared_registry),
+      open_list(num_threads * opts.get<int>("queues_per_thread"),
+                opts.get<int>("choices")),
+      num_unfinished_states(0),
+      search_finished(false),
+      goal_state_id(StateID::no_state) {
+    assert(static_cast<int>(evaluators.size()) == num_threads);
+    shared_ptr<utils::RandomNumberGenerator> rng =
+        utils::parse_rng_from_options(opts);
+    for (const shared_ptr<Evaluator> &evaluator : evaluators) {
+        set<Evaluator *> path_dependent_evaluators;
+        evaluator->get_path_dependent_evaluators(path_dependent_evaluators);
+        if (!path_dependent_evaluators.empty()) {
+            cerr << "parallel_greedy does not support path-dependent "
+                 << "evaluators." << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_UNSUPPORTED);
+        }
+        workers.push_back(utils::make_unique_ptr<Worker>(
+                              evaluator, rng->random(numeric_limits<int>::max()),
+                              log));
+    }
+}
+
+void ParallelGreedySearch::initialize() {
+    log << "Conducting parallel greedy best-first search with "
+        << num_threads << " thread(s), (real) bound = " << bound << endl;
+    State initial_state = shared_registry.get_initial_state();
+
+    vector<shared_ptr<Evaluator>> other_evaluators;
+    for (int i = 1; i < num_threads; ++i) {
+        other_evaluators.push_back(workers[i]->evaluator);
+    }
+    parallel_search_common::subscribe_evaluators(initial_state, other_evaluators);
+    Worker &worker = *workers[0];
+    EvaluationContext eval_context(initial_state, 0, false, &worker.statistics);
+    print_initial_evaluator_values(eval_context, log);
+
+    NodeInfo &info = search_nodes[initial_state];
+    info.reached = true;
+    info.g = 0;
+    info.real_g = 0;
+    if (!insert(worker, initial_state)) {
+        log << "Initial state is a dead end." << endl;
+    }
+}
+
+/*
+  Evaluate a state that the worker has just claimed and insert it into
+  the open list. Return false if the state is a dead end.
+*/
+bool ParallelGreedySearch::insert(Worker &worker, const State &state) {
+    const NodeInfo &info = search_nodes[state.get_id()];
+    EvaluationContext eval_context(state, info.g, false, &worker.statistics);
+    worker.statistics.inc_evaluated_states();
+    Evaluator *evaluator = worker.evaluator.get();
+    if (eval_context.is_evaluator_value_infinite(evaluator)) {
+        worker.statistics.inc_dead_ends();
+        return false;
+    }
+    int h = eval_context.get_evaluator_value(evaluator);
+    // Count the state before another thread can pop it.
+    num_unfinished_states.fetch_add(1);
+    open_list.push(h, state.get_id(), worker.rng);
+    return true;
+}
+
+/*
+  Every state is inserted into the open list only once, by the thread
+  that generates it first, so it is also expanded only once. Like eager
+  greedy search, we test for goal states when they are expanded and
+  never reopen states.
+*/
+void ParallelGreedySearch::expand(Worker &worker, StateID id) {
+    State state = shared_registry.lookup_state(id);
+    worker.statistics.inc_expanded();
+    if (task_properties::is_goal_state(task_proxy, state)) {
+        lock_guard<mutex> lock(goal_mutex);
+        if (goal_state_id == StateID::no_state) {
+            goal_state_id = id;
+        }
+        search_finished = true;
+        return;
+    }
+
+    const NodeInfo &info = search_nodes[id];
+    int g = info.g;
+    int real_g = info.real_g;
+    vector<OperatorID> &applicable_ops = worker.applicable_ops;
+    applicable_ops.clear();
+    successor_generator.generate_applicable_ops(state, applicable_ops);
+    worker.statistics.inc_generated_ops(applicable_ops.size());
+    for (OperatorID op_id : applicable_ops) {
+        OperatorProxy op = task_proxy.get_operators()[op_id];
+        if (real_g + op.get_cost() >= bound) {
+            continue;
+        }
+        State succ_state = shared_registry.get_successor_state(state, op);
+        worker.statistics.inc_generated();
+        NodeInfo &succ_info = search_nodes[succ_state.get_id()];
+        if (succ_info.reached.exchange(true, memory_order_acq_rel)) {
+            continue;
+        }
+        succ_info.g = g + get_adjusted_cost(op);
+        succ_info.real_g = real_g + op.get_cost();
+        succ_info.parent_state_id = id;
+        succ_info.creating_operator = op_id;
+        insert(worker, succ_state);
+    }
+}
+
+void ParallelGreedySearch::run_worker(
+    Worker &worker, const utils::CountdownTimer &timer) {
+    while (!search_finished.load(memory_order_acquire)) {
+        StateID id = StateID::no_state;
+        if (open_list.pop(id, worker.rng)) {
+            expand(worker, id);
+            num_unfinished_states.fetch_sub(1);
+        } else if (num_unfinished_states.load() == 0) {
+            search_finished = true;
+        } else {
+            // Other threads are still expanding states.
+            this_thread::yield();
+        }
+        if (timer.is_expired() || is_stop_requested()) {
+            search_finished = true;
+        }
+    }
+}
+
+void ParallelGreedySearch::trace_path(StateID goal_id, Plan &plan) {
+    assert(plan.empty());
+    StateID current_id = goal_id;
+    for (;;) {
+        const NodeInfo &info = search_nodes[current_id];
+        if (info.creating_operator == OperatorID::no_operator) {
+            assert(info.parent_state_id == StateID::no_state);
+            break;
+        }
+        plan.push_back(info.creating_operator);
+        current_id = info.parent_state_id;
+    }
+    reverse(plan.begin(), plan.end());
+}
+
+/*
+  A single step runs all worker threads until one of them expands a goal
+  state, the search space is exhausted, or the time limit is reached.
+*/
+SearchStatus ParallelGreedySearch::step() {
+    utils::CountdownTimer timer(max_time);
+    vector<thread> threads;
+    for (int i = 1; i < num_threads; ++i) {
+        threads.emplace_back(&ParallelGreedySearch::run_worker, this,
+                             ref(*workers[i]), cref(timer));
+    }
+    run_worker(*workers[0], timer);
+    for (thread &worker_thread : threads) {
+        worker_thread.join();
+    }
+
+    for (const unique_ptr<Worker> &worker : workers) {
+        parallel_search_common::add_worker_statistics(
+            statistics, worker->statistics);
+    }
+
+    if (goal_state_id != StateID::no_state) {
+        log << "Solution found!" << endl;
+        Plan plan;
+        trace_path(goal_state_id, plan);
+        set_plan(plan);
+        return SOLVED;
+    }
+    if (num_unfinished_states.load() != 0) {
+        // SearchEngine::search() reports the timeout.
+        return IN_PROGRESS;
+    }
+    log << "Completely explored state space -- no solution!" << endl;
+    return FAILED;
+}
+
+void ParallelGreedySearch::print_statistics() const {
+    statistics.print_detailed_statistics();
+    log << "Expanded states per thread:";
+    for (const unique_ptr<Worker> &worker : workers) {
+        log << " " << worker->statistics.get_expanded();
+    }
+    log << endl;
+    shared_registry.print_statistics(log);
+}
+
+static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Parallel greedy best-first search",
+        "Greedy best-first search with several worker threads that share "
+        "one open list (k-PGBFS). Every thread repeatedly removes a state "
+        "with a low heuristic value from the open list, expands it, and "
+        "evaluates and inserts the successors that no thread has generated "
+        "before. All threads share a thread-safe state registry.");
+    parser.document_note(
+        "Open list",
+        "The open list is a multi-queue: a set of binary heaps with one lock "
+        "each. States are inserted into a random heap, and threads remove "
+        "the best state from the best of several randomly chosen heaps. "
+        "Therefore the expansion order deviates from the order of "
+        "sequential greedy best-first search. Fewer heaps per thread and "
+        "more choices make the order stricter but increase contention. "
+        "With one thread and one heap per thread, states are expanded in "
+        "the order of sequential greedy best-first search with FIFO "
+        "tie-breaking.");
+    parser.document_note(
+        "Evaluators",
+        "Every thread has its own copy of the evaluator, so the evaluator "
+        "must be defined inline rather than predefined with --evaluator. "
+        "Path-dependent evaluators and preferred operators are not "
+        "supported.");
+    parser.add_option<ParseTree>("eval", "evaluator for h-value");
+    parallel_search_common::add_threads_option_to_parser(parser);
+    parser.add_option<int>(
+        "queues_per_thread",
+        "number of heaps in the open list per thread",
+        "2",
+        Bounds("1", "infinity"));
+    parser.add_option<int>(
+        "choices",
+        "number of randomly chosen heaps that are compared when removing "
+        "a state from the open list",
+        "2",
+        Bounds("1", "infinity"));
+    utils::add_rng_options(parser);
+    SearchEngine::add_options_to_parser(parser);
+    Options opts = parser.parse();
+
+    if (parser.help_mode()) {
+        return nullptr;
+    }
+
+    if (opts.get<bool>("compress_states")) {
+        parser.error("parallel_greedy does not support compress_states");
+    }
+    if (opts.contains("state_pool_directory")) {
+        parser.error("parallel_greedy does not support state_pool_directory");
+    }
+
+    vector<shared_ptr<Evaluator>> evaluators =
+        parallel_search_common::create_evaluators_for_threads(
+            parser, opts.get<ParseTree>("eval"), opts.get<int>("threads"));
+
+    shared_ptr<ParallelGreedySearch> engine;
+    if (!parser.dry_run()) {
+        engine = make_shared<ParallelGreedySearch>(opts, evaluators);
+    }
+
+    return engine;
+}
+
+static Plugin<SearchEngine> _plugin("parallel_greedy", _parse);
+}
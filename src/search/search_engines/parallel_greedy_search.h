@@ -0,0 +1,105 @@
+#ifndef SEARCH_ENGINES_PARALLEL_GREEDY_SEARCH_H
+#define SEARCH_ENGINES_PARALLEL_GREEDY_SEARCH_H
+
+#include "../concurrent_per_state_information.h"
+#include "../operator_id.h"
+#include "../search_engine.h"
+#include "../search_statistics.h"
+#include "../state_registry.h"
+
+#include "../algorithms/multi_queue.h"
+#include "../utils/rng.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Evaluator;
+
+namespace options {
+class Options;
+}
+
+namespace utils {
+class CountdownTimer;
+}
+
+namespace parallel_greedy_search {
+/*
+  Search node of a state. The first thread that generates a state claims
+  it by setting reached and is the only one to write the other fields.
+*/
+struct NodeInfo {
+    std::atomic<bool> reached;
+    int g;
+    int real_g;
+    StateID parent_state_id;
+    OperatorID creating_operator;
+
+    NodeInfo()
+        : reached(false), g(-1), real_g(-1),
+          parent_state_id(StateID::no_state),
+          creating_operator(OperatorID::no_operator) {
+    }
+
+    // Only used to initialize new segments with the default value.
+    NodeInfo(const NodeInfo &other)
+        : reached(other.reached.load(std::memory_order_relaxed)),
+          g(other.g), real_g(other.real_g),
+          parent_state_id(other.parent_state_id),
+          creating_operator(other.creating_operator) {
+    }
+};
+
+class ParallelGreedySearch : public SearchEngine {
+    // Data of one worker thread, which has its own evaluator.
+    struct Worker {
+        std::shared_ptr<Evaluator> evaluator;
+        utils::RandomNumberGenerator rng;
+        std::vector<OperatorID> applicable_ops;
+        SearchStatistics statistics;
+
+        Worker(const std::shared_ptr<Evaluator> &evaluator, int seed,
+               utils::LogProxy &log);
+    };
+
+    const int num_threads;
+
+    // Shared by all workers; SearchEngine::state_registry is not used.
+    StateRegistry shared_registry;
+    ConcurrentPerStateInformation<NodeInfo> search_nodes;
+    multi_queue::MultiQueue<StateID> open_list;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /*
+      Number of states that have been inserted into the open list but
+      whose expansion has not finished yet. Successors are inserted
+      before the expansion of their parent counts as finished, so when
+      this counter drops to 0, the search space is exhausted.
+    */
+    std::atomic<long long> num_unfinished_states;
+    std::atomic<bool> search_finished;
+    std::mutex goal_mutex;
+    StateID goal_state_id;
+
+    bool insert(Worker &worker, const State &state);
+    void expand(Worker &worker, StateID id);
+    void run_worker(Worker &worker, const utils::CountdownTimer &timer);
+    void trace_path(StateID goal_id, Plan &plan);
+
+protected:
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+
+public:
+    ParallelGreedySearch(
+        const options::Options &opts,
+        const std::vector<std::shared_ptr<Evaluator>> &evaluators);
+    virtual ~ParallelGreedySearch() = default;
+
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
@@ -0,0 +1,210 @@
+#include "parallel_portfolio_search.h"
+
+#include "parallel_search_common.h"
+
+#include "../option_parser.h"
+#include "../option_parser_util.h"
+#include "../plugin.h"
+
+#include "../utils/countdown_timer.h"
+#include "../utils/logging.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace parallel_portfolio_search {
+ParallelPortfolioSearch::ParallelPortfolioSearch(
+    const Options &opts, options::Registry &registry,
+    const options::Predefinitions &predefinitions)
+    : SearchEngine(opts),
+      continue_on_solve(opts.get<bool>("continue_on_solve")),
+      num_finished_engines(0),
+      best_bound(bound) {
+    /*
+      All engines are created before any of them starts because creating
+      engines and evaluators registers data for the task in global caches,
+      which is not thread-safe.
+    */
+    for (const ParseTree &config : opts.get_list<ParseTree>("engine_configs")) {
+        OptionParser parser(config, registry, predefinitions, false);
+        engines.push_back(parser.start_parsing<shared_ptr<SearchEngine>>());
+        engines.back()->set_bound(min(engines.back()->get_bound(), best_bound));
+    }
+}
+
+void ParallelPortfolioSearch::report_plan(int index, const Plan &plan) {
+    int plan_cost = calculate_plan_cost(plan, task_proxy);
+    log << "Search " << index << " found a plan with cost " << plan_cost
+        << endl;
+    if (plan_cost >= best_bound) {
+        return;
+    }
+    plan_manager.save_plan(plan, task_proxy, continue_on_solve);
+    best_bound = plan_cost;
+    set_plan(plan);
+    for (const shared_ptr<SearchEngine> &engine : engines) {
+        if (engine) {
+            if (continue_on_solve) {
+                engine->set_bound(min(engine->get_bound(), best_bound));
+            } else {
+                engine->request_stop();
+            }
+        }
+    }
+}
+
+void ParallelPortfolioSearch::run_engine(int index) {
+    shared_ptr<SearchEngine> engine = engines[index];
+    engine->search();
+
+    lock_guard<mutex> lock(portfolio_mutex);
+    engines[index] = nullptr;
+    if (engine->found_solution()) {
+        report_plan(index, engine->get_plan());
+    }
+    log << "Statistics of search " << index << ":" << endl;
+    engine->print_statistics();
+
+    parallel_search_common::add_worker_statistics(
+        statistics, engine->get_statistics());
+
+    ++num_finished_engines;
+    engine_finished.notify_all();
+}
+
+/*
+  A single step runs all engines until they have finished or the time
+  limit is reached. The time limit counts the CPU time of all threads,
+  so we cannot wait for a wall-clock deadline and poll the timer instead.
+*/
+SearchStatus ParallelPortfolioSearch::step() {
+    int num_engines = engines.size();
+    log << "Starting " << num_engines << " searches in parallel." << endl;
+    vector<thread> threads;
+    for (int i = 0; i < num_engines; ++i) {
+        threads.emplace_back(&ParallelPortfolioSearch::run_engine, this, i);
+    }
+
+    utils::CountdownTimer timer(max_time);
+    bool timed_out = false;
+    {
+        unique_lock<mutex> lock(portfolio_mutex);
+        while (num_finished_engines < num_engines) {
+            engine_finished.wait_for(lock, chrono::milliseconds(100));
+            if (!timed_out && (timer.is_expired() || is_stop_requested())) {
+                timed_out = true;
+                for (const shared_ptr<SearchEngine> &engine : engines) {
+                    if (engine) {
+                        engine->request_stop();
+                    }
+                }
+            }
+        }
+    }
+    for (thread &engine_thread : threads) {
+        engine_thread.join();
+    }
+
+    if (found_solution()) {
+        return SOLVED;
+    }
+    // SearchEngine::search() reports the timeout.
+    return timed_out ? IN_PROGRESS : FAILED;
+}
+
+void ParallelPortfolioSearch::print_statistics() const {
+    log << "Cumulative statistics:" << endl;
+    statistics.print_detailed_statistics();
+}
+
+void ParallelPortfolioSearch::save_plan_if_necessary() {
+    // We don't need to save here, as we save every improving plan.
+}
+
+/*
+  Evaluators are not thread-safe, so the engines must not share evaluator
+  objects. Engines only share objects through predefinitions, and a
+  predefined evaluator may contain other predefined evaluators, which we
+  cannot see in the configurations. Therefore at most one engine may use
+  predefined evaluators.
+*/
+static void verify_no_shared_evaluators(
+    OptionParser &parser, const vector<ParseTree> &engine_configs) {
+    int engine_with_predefined_evaluator = -1;
+    for (size_t i = 0; i < engine_configs.size(); ++i) {
+        if (!parallel_search_common::uses_predefined_evaluators(
+                engine_configs[i], parser.get_predefinitions())) {
+            continue;
+        }
+        if (engine_with_predefined_evaluator == -1) {
+            engine_with_predefined_evaluator = i;
+        } else {
+            parser.error(
+                "searches " + to_string(engine_with_predefined_evaluator) +
+                " and " + to_string(i) + " use predefined evaluators, "
+                "which they might share; define the evaluators inline");
+        }
+    }
+}
+
+static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Parallel portfolio search",
+        "Runs several search engines at the same time, each on its own "
+        "thread, on the same task in this planner process. The task, the "
+        "successor generator and other per-task data are shared.");
+    parser.document_note(
+        "Stopping",
+        "By default, all searches are stopped as soon as one of them finds "
+        "a plan. With continue_on_solve=true, the other searches continue "
+        "and the cost of the best plan found so far is passed to them as "
+        "a bound, so they only look for cheaper plans. Every improving "
+        "plan is then saved to a new plan file.");
+    parser.document_note(
+        "Evaluators",
+        "The searches run concurrently, but evaluators are not "
+        "thread-safe. Therefore the searches must not share evaluators: "
+        "define them inline instead of predefining them with --evaluator. "
+        "At most one search may use predefined evaluators. "
+        "Engines that create other engines during the search (such as "
+        "iterated) are not supported in the portfolio.");
+    parser.document_note(
+        "Time limits",
+        "Time limits count the CPU time of the whole planner process, "
+        "i.e., of all threads together.");
+    parser.add_list_option<ParseTree>("engine_configs",
+                                      "search engines that run in parallel");
+    parser.add_option<bool>(
+        "continue_on_solve",
+        "continue the other searches with the plan cost as bound after a "
+        "plan was found",
+        "false");
+    SearchEngine::add_options_to_parser(parser);
+    Options opts = parser.parse();
+
+    opts.verify_list_non_empty<ParseTree>("engine_configs");
+
+    if (parser.help_mode()) {
+        return nullptr;
+    }
+    verify_no_shared_evaluators(
+        parser, opts.get_list<ParseTree>("engine_configs"));
+    if (parser.dry_run()) {
+        for (const ParseTree &config : opts.get_list<ParseTree>("engine_configs")) {
+            OptionParser test_parser(config, parser.get_registry(),
+                                     parser.get_predefinitions(), true);
+            test_parser.start_parsing<shared_ptr<SearchEngine>>();
+        }
+        return nullptr;
+    } else {
+        return make_shared<ParallelPortfolioSearch>(
+            opts, parser.get_registry(), parser.get_predefinitions());
+    }
+}
+
+static Plugin<SearchEngine> _plugin("parallel_portfolio", _parse);
+}
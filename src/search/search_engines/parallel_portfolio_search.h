@@ -0,0 +1,48 @@
+#ifndef SEARCH_ENGINES_PARALLEL_PORTFOLIO_SEARCH_H
+#define SEARCH_ENGINES_PARALLEL_PORTFOLIO_SEARCH_H
+
+#include "../search_engine.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace options {
+class Options;
+class Predefinitions;
+class Registry;
+}
+
+namespace parallel_portfolio_search {
+class ParallelPortfolioSearch : public SearchEngine {
+    const bool continue_on_solve;
+
+    /*
+      The engines of the portfolio. An engine is destroyed when its search
+      has finished to free its memory for the engines that still run.
+    */
+    std::vector<std::shared_ptr<SearchEngine>> engines;
+
+    // Guards all members below, the plan and the statistics.
+    std::mutex portfolio_mutex;
+    std::condition_variable engine_finished;
+    int num_finished_engines;
+    int best_bound;
+
+    void run_engine(int index);
+    void report_plan(int index, const Plan &plan);
+
+    virtual SearchStatus step() override;
+
+public:
+    ParallelPortfolioSearch(const options::Options &opts,
+                            options::Registry &registry,
+                            const options::Predefinitions &predefinitions);
+
+    virtual void save_plan_if_necessary() override;
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include "parallel_search_common.h"
+
+#include "../evaluation_context.h"
+#include "../evaluator.h"
+#include "../option_parser.h"
+#include "../search_statistics.h"
+
+using namespace std;
+
+namespace parallel_search_common {
+void add_threads_option_to_parser(OptionParser &parser) {
+    parser.add_option<int>(
+        "threads",
+        "number of worker threads",
+        "1",
+        Bounds("1", "infinity"));
+}
+
+bool uses_predefined_evaluators(
+    const options::ParseTree &config,
+    const options::Predefinitions &predefinitions) {
+    for (auto it = config.begin(); it != config.end(); ++it) {
+        if (predefinitions.contains_type<shared_ptr<Evaluator>>(it->value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<shared_ptr<Evaluator>> create_evaluators_for_threads(
+    options::OptionParser &parser, const options::ParseTree &config,
+    int num_threads) {
+    const options::Predefinitions &predefinitions = parser.get_predefinitions();
+    if (num_threads > 1 && uses_predefined_evaluators(config, predefinitions)) {
+        parser.error(
+            "each worker thread needs its own evaluators; define the "
+            "evaluators inline instead of using predefined evaluators");
+    }
+
+    vector<shared_ptr<Evaluator>> evaluators;
+    if (parser.dry_run()) {
+        options::OptionParser test_parser(
+            config, parser.get_registry(), predefinitions, true);
+        test_parser.start_parsing<shared_ptr<Evaluator>>();
+        return evaluators;
+    }
+
+    for (int i = 0; i < num_threads; ++i) {
+        options::OptionParser thread_parser(
+            config, parser.get_registry(), predefinitions, false);
+        evaluators.push_back(thread_parser.start_parsing<shared_ptr<Evaluator>>());
+    }
+    return evaluators;
+}
+
+void subscribe_evaluators(
+    const State &state, const vector<shared_ptr<Evaluator>> &evaluators) {
+    for (const shared_ptr<Evaluator> &evaluator : evaluators) {
+        EvaluationContext eval_context(state, 0, false, nullptr);
+        eval_context.get_result(evaluator.get());
+    }
+}
+
+void add_worker_statistics(
+    SearchStatistics &statistics, const SearchStatistics &worker_statistics) {
+    statistics.inc_expanded(worker_statistics.get_expanded());
+    statistics.inc_evaluated_states(worker_statistics.get_evaluated_states());
+    statistics.inc_evaluations(worker_statistics.get_evaluations());
+    statistics.inc_generated(worker_statistics.get_generated());
+    statistics.inc_reopened(worker_statistics.get_reopened());
+    statistics.inc_generated_ops(worker_statistics.get_generated_ops());
+    statistics.inc_dead_ends(worker_statistics.get_dead_ends());
+}
+}
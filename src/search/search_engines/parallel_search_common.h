@@ -0,0 +1,74 @@
+#ifndef SEARCH_ENGINES_PARALLEL_SEARCH_COMMON_H
+#define SEARCH_ENGINES_PARALLEL_SEARCH_COMMON_H
+
+/*
+  This module contains functions shared by the search engines that run
+  several worker threads in one planner process.
+
+  Evaluators are not thread-safe: most heuristics keep scratch data for
+  the current evaluation and a cache that is indexed by state. Therefore
+  every worker thread gets its own evaluator objects, which we obtain by
+  parsing the evaluator configuration once per thread.
+*/
+
+#include "../options/parse_tree.h"
+
+#include <memory>
+#include <vector>
+
+class Evaluator;
+class SearchStatistics;
+class State;
+
+namespace options {
+class OptionParser;
+class Predefinitions;
+}
+
+namespace parallel_search_common {
+/*
+  Add the "threads" option that sets the number of worker threads.
+*/
+extern void add_threads_option_to_parser(options::OptionParser &parser);
+
+/*
+  Return true if the given configuration uses an evaluator that is
+  predefined with "--evaluator" anywhere in its parse tree, also nested
+  inside other evaluators.
+*/
+extern bool uses_predefined_evaluators(
+    const options::ParseTree &config,
+    const options::Predefinitions &predefinitions);
+
+/*
+  Parse the given evaluator configuration num_threads times and return
+  the resulting evaluators, one for each worker thread. In a dry run, the
+  configuration is only checked and an empty vector is returned.
+
+  Evaluators that are predefined with "--evaluator" are the same object
+  every time they are parsed. Sharing them between threads is unsafe, so
+  we report an input error if more than one thread is requested for a
+  configuration that uses predefined evaluators.
+*/
+extern std::vector<std::shared_ptr<Evaluator>> create_evaluators_for_threads(
+    options::OptionParser &parser, const options::ParseTree &config,
+    int num_threads);
+
+/*
+  Heuristics subscribe their caches to the state registry on their first
+  evaluation, and registering subscribers is not thread-safe. Engines
+  therefore call this function with the evaluators that the worker threads
+  have not used yet before they start the threads. It evaluates the given
+  state (usually the initial state) with each evaluator.
+*/
+extern void subscribe_evaluators(
+    const State &state, const std::vector<std::shared_ptr<Evaluator>> &evaluators);
+
+/*
+  Add the counters of a worker's statistics to the given statistics.
+*/
+extern void add_worker_statistics(
+    SearchStatistics &statistics, const SearchStatistics &worker_statistics);
+}
+
+#endif
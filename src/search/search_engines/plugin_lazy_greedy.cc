@@ -58,6 +58,7 @@ static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
         "to preferred operator nodes",
         DEFAULT_LAZY_BOOST);
     SearchEngine::add_succ_order_options(parser);
+    lazy_search::add_lookahead_option_to_parser(parser);
     SearchEngine::add_options_to_parser(parser);
     Options opts = parser.parse();
 
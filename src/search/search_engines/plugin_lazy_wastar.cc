@@ -65,6 +65,7 @@ static shared_ptr<SearchEngine> _parse(OptionParser &parser) {
                            DEFAULT_LAZY_BOOST);
     parser.add_option<int>("w", "evaluator weight", "1");
     SearchEngine::add_succ_order_options(parser);
+    lazy_search::add_lookahead_option_to_parser(parser);
     SearchEngine::add_options_to_parser(parser);
     Options opts = parser.parse();
 
@@ -110,6 +110,19 @@ shared_ptr<OpenListFactory> create_wastar_open_list_factory(
         options.get<int>("boost"));
 }
 
+shared_ptr<OpenListFactory> create_tiebreaking_wastar_open_list_factory(
+    const shared_ptr<Evaluator> &h_eval, int w) {
+    shared_ptr<GEval> g_eval = make_shared<GEval>();
+    vector<shared_ptr<Evaluator>> evals = {
+        create_wastar_eval(g_eval, w, h_eval), h_eval};
+
+    Options options;
+    options.set("evals", evals);
+    options.set("pref_only", false);
+    options.set("unsafe_pruning", false);
+    return make_shared<tiebreaking_open_list::TieBreakingOpenListFactory>(options);
+}
+
 pair<shared_ptr<OpenListFactory>, const shared_ptr<Evaluator>>
 create_astar_open_list_factory_and_f_eval(const Options &opts) {
     shared_ptr<GEval> g = make_shared<GEval>();
@@ -67,6 +67,16 @@ extern std::shared_ptr<OpenListFactory> create_greedy_open_list_factory(
 extern std::shared_ptr<OpenListFactory> create_wastar_open_list_factory(
     const options::Options &opts);
 
+/*
+  Create open list factory for the anytime_wastar plugin.
+
+  The resulting open list factory produces a tie-breaking open list
+  ordered primarily on g + w * h and secondarily on h, where h is the
+  given evaluator.
+*/
+extern std::shared_ptr<OpenListFactory> create_tiebreaking_wastar_open_list_factory(
+    const std::shared_ptr<Evaluator> &h_eval, int w);
+
 /*
   Create open list factory and f_evaluator (used for displaying progress
   statistics) for A* search.
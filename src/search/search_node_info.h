@@ -12,13 +12,23 @@ struct SearchNodeInfo {
 
     unsigned int status : 2;
     int g : 30;
-    StateID parent_state_id;
-    OperatorID creating_operator;
     int real_g;
 
     SearchNodeInfo()
-        : status(NEW), g(-1), parent_state_id(StateID::no_state),
-          creating_operator(-1), real_g(-1) {
+        : status(NEW), g(-1), real_g(-1) {
+    }
+};
+
+/*
+  The parent pointer of a search node is stored separately from the rest of
+  its data, so that searches can do without it (see SearchSpace).
+*/
+struct SearchNodeParentInfo {
+    StateID parent_state_id;
+    OperatorID creating_operator;
+
+    SearchNodeParentInfo()
+        : parent_state_id(StateID::no_state), creating_operator(-1) {
     }
 };
 
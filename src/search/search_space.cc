@@ -1,20 +1,34 @@
 #include "search_space.h"
 
+#include "axioms.h"
 #include "search_node_info.h"
 #include "task_proxy.h"
 
 #include "task_utils/task_properties.h"
 #include "utils/logging.h"
+#include "utils/system.h"
 
+#include <algorithm>
 #include <cassert>
+#include <iostream>
+#include <unordered_set>
 
 using namespace std;
 
-SearchNode::SearchNode(const State &state, SearchNodeInfo &info)
-    : state(state), info(info) {
+SearchNode::SearchNode(const State &state, SearchNodeInfo &info,
+                       SearchNodeParentInfo *parent_info)
+    : state(state), info(info), parent_info(parent_info) {
     assert(state.get_id() != StateID::no_state);
 }
 
+void SearchNode::set_parent(
+    const SearchNode &parent_node, const OperatorProxy &parent_op) {
+    if (parent_info) {
+        parent_info->parent_state_id = parent_node.get_state().get_id();
+        parent_info->creating_operator = OperatorID(parent_op.get_id());
+    }
+}
+
 const State &SearchNode::get_state() const {
     return state;
 }
@@ -49,8 +63,10 @@ void SearchNode::open_initial() {
     info.status = SearchNodeInfo::OPEN;
     info.g = 0;
     info.real_g = 0;
-    info.parent_state_id = StateID::no_state;
-    info.creating_operator = OperatorID::no_operator;
+    if (parent_info) {
+        parent_info->parent_state_id = StateID::no_state;
+        parent_info->creating_operator = OperatorID::no_operator;
+    }
 }
 
 void SearchNode::open(const SearchNode &parent_node,
@@ -60,8 +76,7 @@ void SearchNode::open(const SearchNode &parent_node,
     info.status = SearchNodeInfo::OPEN;
     info.g = parent_node.info.g + adjusted_cost;
     info.real_g = parent_node.info.real_g + parent_op.get_cost();
-    info.parent_state_id = parent_node.get_state().get_id();
-    info.creating_operator = OperatorID(parent_op.get_id());
+    set_parent(parent_node, parent_op);
 }
 
 void SearchNode::reopen(const SearchNode &parent_node,
@@ -75,8 +90,7 @@ void SearchNode::reopen(const SearchNode &parent_node,
     info.status = SearchNodeInfo::OPEN;
     info.g = parent_node.info.g + adjusted_cost;
     info.real_g = parent_node.info.real_g + parent_op.get_cost();
-    info.parent_state_id = parent_node.get_state().get_id();
-    info.creating_operator = OperatorID(parent_op.get_id());
+    set_parent(parent_node, parent_op);
 }
 
 // like reopen, except doesn't change status
@@ -89,8 +103,7 @@ void SearchNode::update_parent(const SearchNode &parent_node,
     // may require reopening closed nodes.
     info.g = parent_node.info.g + adjusted_cost;
     info.real_g = parent_node.info.real_g + parent_op.get_cost();
-    info.parent_state_id = parent_node.get_state().get_id();
-    info.creating_operator = OperatorID(parent_op.get_id());
+    set_parent(parent_node, parent_op);
 }
 
 void SearchNode::close() {
@@ -105,22 +118,194 @@ void SearchNode::mark_as_dead_end() {
 void SearchNode::dump(const TaskProxy &task_proxy, utils::LogProxy &log) const {
     log << state.get_id() << ": ";
     task_properties::dump_fdr(state);
-    if (info.creating_operator != OperatorID::no_operator) {
+    if (!parent_info) {
+        log << " parent not stored" << endl;
+    } else if (parent_info->creating_operator != OperatorID::no_operator) {
         OperatorsProxy operators = task_proxy.get_operators();
-        OperatorProxy op = operators[info.creating_operator.get_index()];
+        OperatorProxy op = operators[parent_info->creating_operator.get_index()];
         log << " created by " << op.get_name()
-            << " from " << info.parent_state_id << endl;
+            << " from " << parent_info->parent_state_id << endl;
     } else {
         log << " no parent" << endl;
     }
 }
 
-SearchSpace::SearchSpace(StateRegistry &state_registry, utils::LogProxy &log)
-    : state_registry(state_registry), log(log) {
+SearchSpace::SearchSpace(StateRegistry &state_registry, utils::LogProxy &log,
+                         bool store_parents, OperatorCost cost_type)
+    : search_node_infos(state_registry),
+      parent_infos(state_registry),
+      store_parents(store_parents),
+      cost_type(cost_type),
+      is_unit_cost(task_properties::is_unit_cost(state_registry.get_task_proxy())),
+      state_registry(state_registry), log(log) {
 }
 
 SearchNode SearchSpace::get_node(const State &state) {
-    return SearchNode(state, search_node_infos[state]);
+    return SearchNode(state, search_node_infos[state],
+                      store_parents ? &parent_infos[state] : nullptr);
+}
+
+vector<pair<StateID, OperatorID>> SearchSpace::get_regression_predecessors(
+    const State &state) const {
+    const TaskProxy &task_proxy = state_registry.get_task_proxy();
+    VariablesProxy variables = task_proxy.get_variables();
+    AxiomEvaluator &axiom_evaluator = g_axiom_evaluators[task_proxy];
+    state.unpack();
+    const vector<int> &values = state.get_unpacked_values();
+    int g = search_node_infos[state].g;
+
+    // Predecessors with their g values.
+    vector<pair<int, pair<StateID, OperatorID>>> predecessors;
+    vector<int> precondition_values(variables.size(), -1);
+    for (OperatorProxy op : task_proxy.get_operators()) {
+        for (FactProxy pre : op.get_preconditions()) {
+            FactPair fact = pre.get_pair();
+            precondition_values[fact.var] = fact.value;
+        }
+        /*
+          Start from the values of state and set the preconditions. The
+          variables that op changes without a precondition (free variables)
+          can only have a value different from state in the predecessor if
+          an effect that produces their value in state fired. For such an
+          effect, the predecessor value is given by the effect condition on
+          the variable if there is one, and can be any value otherwise.
+          Effects that did not fire and axioms are handled by checking that
+          op actually leads from the candidate to state.
+        */
+        vector<int> candidate_values = values;
+        vector<int> free_vars;
+        // The values that we try for the free variables.
+        vector<vector<int>> free_var_values;
+        bool consistent = true;
+        for (EffectProxy effect : op.get_effects()) {
+            FactPair fact = effect.get_fact().get_pair();
+            if (effect.get_conditions().empty() && values[fact.var] != fact.value) {
+                consistent = false;
+            }
+            if (precondition_values[fact.var] != -1) {
+                continue;
+            }
+            size_t index = find(free_vars.begin(), free_vars.end(), fact.var) -
+                free_vars.begin();
+            if (index == free_vars.size()) {
+                free_vars.push_back(fact.var);
+                free_var_values.push_back({values[fact.var]});
+            }
+            if (fact.value != values[fact.var]) {
+                continue;
+            }
+            vector<int> &var_values = free_var_values[index];
+            int condition_value = -1;
+            for (FactProxy condition : effect.get_conditions()) {
+                if (condition.get_variable().get_id() == fact.var) {
+                    condition_value = condition.get_value();
+                }
+            }
+            if (condition_value != -1) {
+                var_values.push_back(condition_value);
+            } else {
+                for (int value = 0; value < variables[fact.var].get_domain_size(); ++value) {
+                    var_values.push_back(value);
+                }
+            }
+        }
+        for (vector<int> &var_values : free_var_values) {
+            sort(var_values.begin(), var_values.end());
+            var_values.erase(unique(var_values.begin(), var_values.end()),
+                             var_values.end());
+        }
+        for (FactProxy pre : op.get_preconditions()) {
+            FactPair fact = pre.get_pair();
+            candidate_values[fact.var] = fact.value;
+            precondition_values[fact.var] = -1;
+        }
+
+        int adjusted_cost = get_adjusted_action_cost(op, cost_type, is_unit_cost);
+        // Index into free_var_values for every free variable.
+        vector<size_t> value_indices(free_vars.size(), 0);
+        while (consistent) {
+            for (size_t i = 0; i < free_vars.size(); ++i) {
+                candidate_values[free_vars[i]] =
+                    free_var_values[i][value_indices[i]];
+            }
+            vector<int> predecessor_values = candidate_values;
+            axiom_evaluator.evaluate(predecessor_values);
+            State predecessor = task_proxy.create_state(move(predecessor_values));
+            if (task_properties::is_applicable(op, predecessor) &&
+                predecessor.get_unregistered_successor(op).get_unpacked_values() == values) {
+                StateID id = state_registry.find_state(
+                    predecessor.get_unpacked_values());
+                if (id != StateID::no_state) {
+                    const SearchNodeInfo &info =
+                        search_node_infos[state_registry.lookup_state(id)];
+                    if (info.status != SearchNodeInfo::NEW &&
+                        info.status != SearchNodeInfo::DEAD_END &&
+                        info.g + adjusted_cost <= g) {
+                        predecessors.emplace_back(
+                            info.g, make_pair(id, OperatorID(op.get_id())));
+                    }
+                }
+            }
+            // Move on to the next assignment of the free variables.
+            consistent = false;
+            for (size_t i = 0; i < free_vars.size(); ++i) {
+                if (++value_indices[i] < free_var_values[i].size()) {
+                    consistent = true;
+                    break;
+                }
+                value_indices[i] = 0;
+            }
+        }
+    }
+    // Try predecessors closer to the initial state first.
+    stable_sort(predecessors.begin(), predecessors.end(),
+                [](const pair<int, pair<StateID, OperatorID>> &lhs,
+                   const pair<int, pair<StateID, OperatorID>> &rhs) {
+                    return lhs.first < rhs.first;
+                });
+    vector<pair<StateID, OperatorID>> result;
+    result.reserve(predecessors.size());
+    for (const auto &predecessor : predecessors) {
+        result.push_back(predecessor.second);
+    }
+    return result;
+}
+
+void SearchSpace::trace_path_by_regression(
+    const State &goal_state, vector<OperatorID> &path) const {
+    StateID initial_id = state_registry.get_initial_state().get_id();
+    struct Step {
+        StateID id;
+        vector<pair<StateID, OperatorID>> predecessors;
+        size_t next_predecessor;
+    };
+    vector<Step> steps;
+    unordered_set<int> visited;
+    steps.push_back({goal_state.get_id(), {}, 0});
+    visited.insert(goal_state.get_id().value);
+    while (steps.back().id != initial_id) {
+        Step &step = steps.back();
+        if (step.next_predecessor == 0) {
+            step.predecessors = get_regression_predecessors(
+                state_registry.lookup_state(step.id));
+        }
+        if (step.next_predecessor == step.predecessors.size()) {
+            steps.pop_back();
+            if (steps.empty()) {
+                cerr << "Could not reconstruct the plan by regression." << endl;
+                utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+            }
+            continue;
+        }
+        StateID predecessor_id = step.predecessors[step.next_predecessor++].first;
+        if (visited.insert(predecessor_id.value).second) {
+            steps.push_back({predecessor_id, {}, 0});
+        }
+    }
+    for (size_t i = 0; i + 1 < steps.size(); ++i) {
+        path.push_back(steps[i].predecessors[steps[i].next_predecessor - 1].second);
+    }
+    reverse(path.begin(), path.end());
 }
 
 void SearchSpace::trace_path(const State &goal_state,
@@ -128,8 +313,12 @@ void SearchSpace::trace_path(const State &goal_state,
     State current_state = goal_state;
     assert(current_state.get_registry() == &state_registry);
     assert(path.empty());
+    if (!store_parents) {
+        trace_path_by_regression(goal_state, path);
+        return;
+    }
     for (;;) {
-        const SearchNodeInfo &info = search_node_infos[current_state];
+        const SearchNodeParentInfo &info = parent_infos[current_state];
         if (info.creating_operator == OperatorID::no_operator) {
             assert(info.parent_state_id == StateID::no_state);
             break;
@@ -146,10 +335,12 @@ void SearchSpace::dump(const TaskProxy &task_proxy) const {
         /* The body duplicates SearchNode::dump() but we cannot create
            a search node without discarding the const qualifier. */
         State state = state_registry.lookup_state(id);
-        const SearchNodeInfo &node_info = search_node_infos[state];
+        const SearchNodeParentInfo &node_info = parent_infos[state];
         log << id << ": ";
         task_properties::dump_fdr(state);
-        if (node_info.creating_operator != OperatorID::no_operator &&
+        if (!store_parents) {
+            log << " parent not stored" << endl;
+        } else if (node_info.creating_operator != OperatorID::no_operator &&
             node_info.parent_state_id != StateID::no_state) {
             OperatorProxy op = operators[node_info.creating_operator.get_index()];
             log << " created by " << op.get_name()
@@ -5,6 +5,7 @@
 #include "per_state_information.h"
 #include "search_node_info.h"
 
+#include <utility>
 #include <vector>
 
 class OperatorProxy;
@@ -18,8 +19,13 @@ class LogProxy;
 class SearchNode {
     State state;
     SearchNodeInfo &info;
+    // nullptr if the search space does not store parent pointers.
+    SearchNodeParentInfo *parent_info;
+
+    void set_parent(const SearchNode &parent_node, const OperatorProxy &parent_op);
 public:
-    SearchNode(const State &state, SearchNodeInfo &info);
+    SearchNode(const State &state, SearchNodeInfo &info,
+               SearchNodeParentInfo *parent_info);
 
     const State &get_state() const;
 
@@ -48,13 +54,47 @@ public:
 };
 
 
+/*
+  By default, the search space stores the parent state and creating
+  operator of every node, which is how plans are traced back from the goal.
+  Without parent pointers (store_parents = false), a node only takes half
+  the memory, and trace_path instead reconstructs the plan by regression:
+  a predecessor of state s is a reached state p with an operator o that
+  leads from p to s and g(p) + cost(o) <= g(s), where g and cost are
+  adjusted by the cost type of the search. The recorded parent of s would
+  satisfy this (the g value of a node is set from its parent's g value and
+  only decreases afterwards), so a depth-first search over such
+  predecessors that never visits a state twice reaches the initial state.
+  Real g values do not work here: with adjusted costs, a cheaper path by
+  adjusted cost can increase the real g value of a parent.
+  The candidates for p are found by regressing s over every operator and
+  looking up the results in the state registry. For the variables that an
+  operator changes without a precondition on them, we try every value
+  that is consistent with s and the effect conditions of the operator.
+  For an effect without a condition on its variable, these are all values
+  of the variable. Therefore every plan step takes time proportional to
+  the sum over all operators of the product of these numbers of values,
+  which grows exponentially with the number of such effects of an
+  operator.
+*/
 class SearchSpace {
     PerStateInformation<SearchNodeInfo> search_node_infos;
+    PerStateInformation<SearchNodeParentInfo> parent_infos;
+    const bool store_parents;
+    // Needed to compute adjusted operator costs for tracing by regression.
+    const OperatorCost cost_type;
+    const bool is_unit_cost;
 
     StateRegistry &state_registry;
     utils::LogProxy &log;
+
+    std::vector<std::pair<StateID, OperatorID>> get_regression_predecessors(
+        const State &state) const;
+    void trace_path_by_regression(const State &goal_state,
+                                  std::vector<OperatorID> &path) const;
 public:
-    SearchSpace(StateRegistry &state_registry, utils::LogProxy &log);
+    SearchSpace(StateRegistry &state_registry, utils::LogProxy &log,
+                bool store_parents = true, OperatorCost cost_type = NORMAL);
 
     SearchNode get_node(const State &state);
     void trace_path(const State &goal_state,
@@ -12,8 +12,14 @@ class StateID {
     template<typename>
     friend class PerStateInformation;
     template<typename>
+    friend class ConcurrentPerStateInformation;
+    template<typename>
     friend class PerStateArray;
     friend class PerStateBitset;
+    friend class SearchSpace;
+    friend class TreeChildArena;
+    friend class TreeSearchNode;
+    friend class TreeSearchSpace;
 
     int value;
     explicit StateID(int value_)
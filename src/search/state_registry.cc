@@ -3,20 +3,115 @@
 #include "per_state_information.h"
 #include "task_proxy.h"
 
+#include "algorithms/concurrent_segmented_vector.h"
+#include "task_utils/effect_packer.h"
 #include "task_utils/task_properties.h"
+#include "task_utils/zobrist_hasher.h"
 #include "utils/logging.h"
+#include "utils/memory.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
 
 using namespace std;
 
-StateRegistry::StateRegistry(const TaskProxy &task_proxy)
+/*
+  The hash sets of thread-safe registries are selected by the highest
+  bits of the state hash because IntHashSet uses the lowest bits to
+  select buckets.
+*/
+static const int NUM_SHARD_BITS = 6;
+
+static_assert(sizeof(PackedStateBin) >= sizeof(int_hash_set::HashType),
+              "Zobrist hashes do not fit into a PackedStateBin");
+
+static atomic<uint64_t> next_registry_serial(1);
+
+struct StateRegistry::ConcurrentStorage {
+    using StateDataPool =
+        segmented_vector::ConcurrentSegmentedArrayVector<PackedStateBin>;
+    using Hash = StateIDSemanticHash<StateDataPool>;
+    using Equal = StateIDSemanticEqual<StateDataPool>;
+    using StateIDSet = int_hash_set::IntHashSet<Hash, Equal>;
+
+    struct Shard {
+        mutex shard_mutex;
+        StateIDSet registered_states;
+
+        Shard(const StateDataPool &state_data_pool, int state_size,
+              int entry_size)
+            : registered_states(
+                  Hash(state_data_pool, state_size, entry_size != state_size),
+                  Equal(state_data_pool, state_size, entry_size)) {
+        }
+    };
+
+    // Identifies the registry in the append buffers of the threads.
+    const uint64_t serial;
+    StateDataPool state_data_pool;
+    Hash hash;
+    vector<unique_ptr<Shard>> shards;
+
+    ConcurrentStorage(int state_size, int entry_size)
+        : serial(next_registry_serial++),
+          state_data_pool(entry_size),
+          hash(state_data_pool, state_size, entry_size != state_size) {
+        for (int i = 0; i < (1 << NUM_SHARD_BITS); ++i) {
+            shards.push_back(
+                utils::make_unique_ptr<Shard>(
+                    state_data_pool, state_size, entry_size));
+        }
+    }
+
+    Shard &get_shard(int id) {
+        return *shards[hash(id) >> (32 - NUM_SHARD_BITS)];
+    }
+};
+
+/*
+  The chunk of IDs to which the current thread appends new states. Every
+  thread has one chunk at a time, so a thread that alternates between
+  several thread-safe registries leaves unused IDs behind.
+*/
+struct AppendBuffer {
+    uint64_t registry_serial;
+    int next_id;
+    int end_id;
+};
+
+static thread_local AppendBuffer append_buffer = {0, 0, 0};
+
+StateRegistry::StateRegistry(
+    const TaskProxy &task_proxy, bool thread_safe, bool zobrist_hashing,
+    bool compress_states, const shared_ptr<utils::MappedFilePool> &mapped_file_pool)
     : task_proxy(task_proxy),
       state_packer(task_properties::g_state_packers[task_proxy]),
+      effect_packer(effect_packer::g_effect_packers[task_proxy]),
       axiom_evaluator(g_axiom_evaluators[task_proxy]),
+      zobrist_hasher(zobrist_hashing ?
+                     &zobrist_hasher::g_zobrist_hashers[task_proxy] : nullptr),
       num_variables(task_proxy.get_variables().size()),
-      state_data_pool(get_bins_per_state()),
+      mapped_file_pool(mapped_file_pool),
+      state_data_pool(get_bins_per_entry(), compress_states,
+                      utils::MappedFileAllocator<PackedStateBin>(mapped_file_pool)),
       registered_states(
-          StateIDSemanticHash(state_data_pool, get_bins_per_state()),
-          StateIDSemanticEqual(state_data_pool, get_bins_per_state())) {
+          StateIDSemanticHash<StateDataPool>(
+              state_data_pool, get_bins_per_state(), zobrist_hashing),
+          StateIDSemanticEqual<StateDataPool>(
+              state_data_pool, get_bins_per_state(), get_bins_per_entry())),
+      num_registered_states(0) {
+    if (thread_safe) {
+        // The compressed data of other threads could not be accessed safely.
+        assert(!compress_states);
+        assert(!mapped_file_pool);
+        concurrent_storage = utils::make_unique_ptr<ConcurrentStorage>(
+            get_bins_per_state(), get_bins_per_entry());
+    }
+}
+
+StateRegistry::~StateRegistry() {
 }
 
 StateID StateRegistry::insert_id_or_pop_state() {
@@ -29,31 +124,106 @@ StateID StateRegistry::insert_id_or_pop_state() {
     StateID id(state_data_pool.size() - 1);
     pair<int, bool> result = registered_states.insert(id.value);
     bool is_new_entry = result.second;
-    if (!is_new_entry) {
+    if (is_new_entry) {
+        num_registered_states.store(
+            registered_states.size(), memory_order_release);
+    } else {
         state_data_pool.pop_back();
     }
     assert(registered_states.size() == static_cast<int>(state_data_pool.size()));
     return StateID(result.first);
 }
 
+/*
+  Return the data slot of the next free ID in the chunk of the current
+  thread, claiming a new chunk if necessary. The slot is only used up by
+  insert_concurrent_slot if it holds a new state.
+*/
+PackedStateBin *StateRegistry::get_free_concurrent_slot() {
+    if (append_buffer.registry_serial != concurrent_storage->serial ||
+        append_buffer.next_id == append_buffer.end_id) {
+        /*
+          Chunks are aligned with the segments of the state data pool, so
+          threads never share a segment.
+        */
+        size_t chunk_size =
+            concurrent_storage->state_data_pool.get_arrays_per_segment();
+        size_t first_id = num_registered_states.fetch_add(chunk_size);
+        if (first_id + chunk_size > static_cast<size_t>(numeric_limits<int>::max())) {
+            cerr << "Ran out of state IDs." << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_OUT_OF_MEMORY);
+        }
+        append_buffer.registry_serial = concurrent_storage->serial;
+        append_buffer.next_id = first_id;
+        append_buffer.end_id = first_id + chunk_size;
+    }
+    return concurrent_storage->state_data_pool[append_buffer.next_id];
+}
+
+StateID StateRegistry::insert_concurrent_slot() {
+    int id = append_buffer.next_id;
+    ConcurrentStorage::Shard &shard = concurrent_storage->get_shard(id);
+    pair<int, bool> result;
+    {
+        lock_guard<mutex> lock(shard.shard_mutex);
+        result = shard.registered_states.insert(id);
+    }
+    if (result.second) {
+        ++append_buffer.next_id;
+    }
+    return StateID(result.first);
+}
+
 State StateRegistry::lookup_state(StateID id) const {
-    const PackedStateBin *buffer = state_data_pool[id.value];
+    const PackedStateBin *buffer;
+    if (concurrent_storage) {
+        const ConcurrentStorage &storage = *concurrent_storage;
+        buffer = storage.state_data_pool[id.value];
+    } else if (state_data_pool.compresses_cold_segments()) {
+        /*
+          The state data may be compressed at any time while other states
+          are registered, so the state needs its own copy.
+        */
+        auto data = make_shared<vector<PackedStateBin>>(get_bins_per_entry());
+        state_data_pool.copy_array(id.value, data->data());
+        return task_proxy.create_state(*this, id, move(data));
+    } else {
+        buffer = state_data_pool[id.value];
+    }
     return task_proxy.create_state(*this, id, buffer);
 }
 
+State StateRegistry::create_registered_state(
+    StateID id, const PackedStateBin *buffer, vector<int> &&values) {
+    if (values.empty()) {
+        return task_proxy.create_state(*this, id, buffer);
+    } else {
+        return task_proxy.create_state(*this, id, buffer, move(values));
+    }
+}
+
 const State &StateRegistry::get_initial_state() {
     if (!cached_initial_state) {
-        int num_bins = get_bins_per_state();
+        int num_bins = get_bins_per_entry();
         unique_ptr<PackedStateBin[]> buffer(new PackedStateBin[num_bins]);
-        // Avoid garbage values in half-full bins.
+        // Avoid garbage values in the bin of the cached hash.
         fill_n(buffer.get(), num_bins, 0);
 
         State initial_state = task_proxy.get_initial_state();
-        for (size_t i = 0; i < initial_state.size(); ++i) {
-            state_packer.set(buffer.get(), i, initial_state[i].get_value());
+        initial_state.unpack();
+        state_packer.pack(buffer.get(), initial_state.get_unpacked_values().data());
+        if (zobrist_hasher) {
+            buffer[get_bins_per_state()] =
+                zobrist_hasher->compute_hash(buffer.get());
+        }
+        StateID id = StateID::no_state;
+        if (concurrent_storage) {
+            copy_n(buffer.get(), num_bins, get_free_concurrent_slot());
+            id = insert_concurrent_slot();
+        } else {
+            state_data_pool.push_back(buffer.get());
+            id = insert_id_or_pop_state();
         }
-        state_data_pool.push_back(buffer.get());
-        StateID id = insert_id_or_pop_state();
         cached_initial_state = utils::make_unique_ptr<State>(lookup_state(id));
     }
     return *cached_initial_state;
@@ -62,48 +232,186 @@ const State &StateRegistry::get_initial_state() {
 //TODO it would be nice to move the actual state creation (and operator application)
 //     out of the StateRegistry. This could for example be done by global functions
 //     operating on state buffers (PackedStateBin *).
+vector<int> StateRegistry::apply_operator(
+    const State &predecessor, const OperatorProxy &op, PackedStateBin *buffer) {
+    effect_packer.apply(op.get_id(), predecessor.get_buffer(), buffer);
+    if (!task_properties::has_axioms(task_proxy)) {
+        return vector<int>();
+    }
+    /*
+      The axiom evaluator works on unpacked data. Only the derived
+      variables change, so only they have to be packed again.
+    */
+    vector<int> new_values(num_variables);
+    state_packer.unpack(buffer, new_values.data());
+    // The axiom evaluator serializes concurrent calls.
+    axiom_evaluator.evaluate(new_values);
+    for (int var : effect_packer.get_derived_variables()) {
+        state_packer.set(buffer, var, new_values[var]);
+    }
+    return new_values;
+}
+
+int_hash_set::HashType StateRegistry::get_zobrist_hash(const State &state) const {
+    assert(zobrist_hasher);
+    if (state.get_registry() == this) {
+        return state.get_buffer()[get_bins_per_state()];
+    }
+    // States of other registries do not necessarily store their hash.
+    return zobrist_hasher->compute_hash(state.get_buffer());
+}
+
 State StateRegistry::get_successor_state(const State &predecessor, const OperatorProxy &op) {
     assert(!op.is_axiom());
-    state_data_pool.push_back(predecessor.get_buffer());
+    if (concurrent_storage) {
+        PackedStateBin *buffer = get_free_concurrent_slot();
+        copy_n(predecessor.get_buffer(), get_bins_per_state(), buffer);
+        vector<int> values = apply_operator(predecessor, op, buffer);
+        if (zobrist_hasher) {
+            buffer[get_bins_per_state()] = zobrist_hasher->compute_successor_hash(
+                get_zobrist_hash(predecessor), op.get_id(),
+                predecessor.get_buffer(), buffer);
+            assert(buffer[get_bins_per_state()] ==
+                   zobrist_hasher->compute_hash(buffer));
+        }
+        StateID id = insert_concurrent_slot();
+        // If the state is a duplicate, its data lives in another slot.
+        const ConcurrentStorage &storage = *concurrent_storage;
+        return create_registered_state(
+            id, storage.state_data_pool[id.value], move(values));
+    }
+    if (zobrist_hasher && predecessor.get_registry() != this) {
+        // Make sure that we do not read beyond the data of the predecessor.
+        vector<PackedStateBin> entry(get_bins_per_entry(), 0);
+        copy_n(predecessor.get_buffer(), get_bins_per_state(), entry.begin());
+        state_data_pool.push_back(entry.data());
+    } else {
+        state_data_pool.push_back(predecessor.get_buffer());
+    }
     PackedStateBin *buffer = state_data_pool[state_data_pool.size() - 1];
-    /* Experiments for issue348 showed that for tasks with axioms it's faster
-       to compute successor states using unpacked data. */
-    if (task_properties::has_axioms(task_proxy)) {
-        predecessor.unpack();
-        vector<int> new_values = predecessor.get_unpacked_values();
-        for (EffectProxy effect : op.get_effects()) {
-            if (does_fire(effect, predecessor)) {
-                FactPair effect_pair = effect.get_fact().get_pair();
-                new_values[effect_pair.var] = effect_pair.value;
-            }
+    vector<int> values = apply_operator(predecessor, op, buffer);
+    if (zobrist_hasher) {
+        buffer[get_bins_per_state()] = zobrist_hasher->compute_successor_hash(
+            get_zobrist_hash(predecessor), op.get_id(),
+            predecessor.get_buffer(), buffer);
+        assert(buffer[get_bins_per_state()] ==
+               zobrist_hasher->compute_hash(buffer));
+    }
+    StateID id = insert_id_or_pop_state();
+    return create_registered_state(id, buffer, move(values));
+}
+
+StateID StateRegistry::find_state(const vector<int> &values) {
+    assert(!concurrent_storage);
+    assert(static_cast<int>(values.size()) == num_variables);
+    vector<PackedStateBin> entry(get_bins_per_entry(), 0);
+    state_packer.pack(entry.data(), values.data());
+    if (zobrist_hasher) {
+        entry[get_bins_per_state()] = zobrist_hasher->compute_hash(entry.data());
+    }
+    // The hash set can only look up states in the state data pool.
+    state_data_pool.push_back(entry.data());
+    int id = registered_states.find(state_data_pool.size() - 1);
+    state_data_pool.pop_back();
+    if (id == -1) {
+        return StateID::no_state;
+    }
+    return StateID(id);
+}
+
+void StateRegistry::compact(const vector<StateID> &remaining_states) {
+    assert(!concurrent_storage);
+    assert(cached_initial_state);
+    assert(!remaining_states.empty() && remaining_states[0].value == 0);
+    notify_and_unsubscribe_all();
+
+    int num_bins = get_bins_per_entry();
+    if (state_data_pool.compresses_cold_segments()) {
+        /*
+          Compressed segments cannot be modified in place, so we copy the
+          remaining states and store them again. The initial state owns a
+          copy of its data, so it stays valid.
+        */
+        vector<PackedStateBin> remaining_data(remaining_states.size() * num_bins);
+        for (size_t i = 0; i < remaining_states.size(); ++i) {
+            assert(i == 0 || remaining_states[i].value > remaining_states[i - 1].value);
+            state_data_pool.copy_array(
+                remaining_states[i].value, &remaining_data[i * num_bins]);
         }
-        axiom_evaluator.evaluate(new_values);
-        for (size_t i = 0; i < new_values.size(); ++i) {
-            state_packer.set(buffer, i, new_values[i]);
+        state_data_pool.clear();
+        for (size_t i = 0; i < remaining_states.size(); ++i) {
+            state_data_pool.push_back(&remaining_data[i * num_bins]);
         }
-        StateID id = insert_id_or_pop_state();
-        return task_proxy.create_state(*this, id, buffer, move(new_values));
     } else {
-        for (EffectProxy effect : op.get_effects()) {
-            if (does_fire(effect, predecessor)) {
-                FactPair effect_pair = effect.get_fact().get_pair();
-                state_packer.set(buffer, effect_pair.var, effect_pair.value);
+        for (size_t i = 0; i < remaining_states.size(); ++i) {
+            int old_id = remaining_states[i].value;
+            assert(old_id >= static_cast<int>(i));
+            assert(i == 0 || old_id > remaining_states[i - 1].value);
+            if (old_id != static_cast<int>(i)) {
+                const PackedStateBin *old_buffer = state_data_pool[old_id];
+                copy(old_buffer, old_buffer + num_bins, state_data_pool[i]);
             }
         }
-        StateID id = insert_id_or_pop_state();
-        return task_proxy.create_state(*this, id, buffer);
+        state_data_pool.truncate(remaining_states.size());
+    }
+
+    registered_states.clear();
+    for (size_t i = 0; i < remaining_states.size(); ++i) {
+        registered_states.insert(i);
+    }
+    assert(registered_states.size() == static_cast<int>(state_data_pool.size()));
+    num_registered_states.store(registered_states.size(), memory_order_release);
+}
+
+size_t StateRegistry::estimate_memory_in_bytes() const {
+    if (concurrent_storage) {
+        size_t bytes = size() * get_bins_per_entry() * sizeof(PackedStateBin);
+        for (const auto &shard : concurrent_storage->shards) {
+            lock_guard<mutex> lock(shard->shard_mutex);
+            bytes += shard->registered_states.estimate_memory_in_bytes();
+        }
+        return bytes;
     }
+    return state_data_pool.estimate_memory_in_bytes() +
+           registered_states.estimate_memory_in_bytes();
 }
 
 int StateRegistry::get_bins_per_state() const {
     return state_packer.get_num_bins();
 }
 
+int StateRegistry::get_bins_per_entry() const {
+    return get_bins_per_state() + (zobrist_hasher ? 1 : 0);
+}
+
 int StateRegistry::get_state_size_in_bytes() const {
     return get_bins_per_state() * sizeof(PackedStateBin);
 }
 
 void StateRegistry::print_statistics(utils::LogProxy &log) const {
+    if (concurrent_storage) {
+        int num_states = 0;
+        for (const auto &shard : concurrent_storage->shards) {
+            lock_guard<mutex> lock(shard->shard_mutex);
+            num_states += shard->registered_states.size();
+        }
+        log << "Number of registered states: " << num_states << endl;
+        log << "Number of state IDs handed out: " << size() << endl;
+        log << "Number of hash set shards: "
+            << concurrent_storage->shards.size() << endl;
+        return;
+    }
     log << "Number of registered states: " << size() << endl;
     registered_states.print_statistics(log);
+    if (state_data_pool.compresses_cold_segments()) {
+        log << "Compressed state data segments: "
+            << state_data_pool.get_num_compressed_segments() << "/"
+            << state_data_pool.get_num_segments() << endl;
+        log << "State data memory: "
+            << state_data_pool.estimate_memory_in_bytes() / 1024 << " KB" << endl;
+    }
+    if (mapped_file_pool) {
+        log << "Memory-mapped file size: "
+            << mapped_file_pool->get_file_size() / 1024 << " KB" << endl;
+    }
 }
@@ -5,13 +5,17 @@
 #include "axioms.h"
 #include "state_id.h"
 
+#include "algorithms/compressible_segmented_vector.h"
 #include "algorithms/int_hash_set.h"
 #include "algorithms/int_packer.h"
-#include "algorithms/segmented_vector.h"
 #include "algorithms/subscriber.h"
 #include "utils/hash.h"
+#include "utils/mapped_file_pool.h"
 
+#include <atomic>
+#include <memory>
 #include <set>
+#include <vector>
 
 /*
   Overview of classes relevant to storing and working with registered states.
@@ -54,7 +58,7 @@
     The StateRegistry also stores the actual state data in a memory friendly way.
     It uses the following class:
 
-  SegmentedArrayVector<PackedStateBin>
+  CompressibleSegmentedArrayVector<PackedStateBin>
     This class is used to store the actual (packed) state data for all states
     while avoiding dynamically allocating each state individually.
     The index within this vector corresponds to the ID of the state.
@@ -66,6 +70,54 @@
     essentially the same as a vector<T> whose size is the number of states in
     the registry.
 
+  ConcurrentPerStateInformation<T>
+    Variant of PerStateInformation for one thread-safe StateRegistry whose
+    entries can be accessed by several threads at once.
+
+  -------------
+
+  Zobrist hashing
+    By default, the hash of a state is computed from its packed data
+    whenever the state is looked up in the hash set. A StateRegistry that is
+    created with zobrist_hashing = true instead stores a Zobrist hash (see
+    ZobristHasher) in an additional bin after the data of every state and
+    derives the hash of a successor from the hash of its predecessor and
+    the effects of the operator. This costs one bin per state and makes
+    computing the hash independent of the size of the state.
+
+  Compressed state data
+    A StateRegistry that is created with compress_states = true compresses
+    the segments of its state data pool that no recently registered state
+    lives in (see CompressibleSegmentedArrayVector). Since the data of
+    compressed states has no fixed location, lookup_state then returns
+    states that own a (decompressed) copy of their packed data. States
+    returned by get_successor_state still point into the pool and must not
+    be kept longer than usual, i.e., while registering many other states.
+
+  Memory-mapped state data
+    A StateRegistry that is created with a MappedFilePool allocates the
+    (uncompressed) segments of its state data pool in a memory-mapped
+    file, so the operating system can move state data that is not used
+    to disk instead of running out of memory. PerStateInformation objects
+    take the segments of their data for this registry from the same pool.
+    The hash set of registered states stays in RAM.
+
+  Thread-safe registries
+    A StateRegistry that is created with thread_safe = true can register
+    states from several threads at once. It stores the state data in a
+    ConcurrentSegmentedArrayVector and distributes the duplicate detection
+    over several hash sets (shards) that are guarded by separate locks.
+    Every thread appends new states to its own chunk of consecutive IDs,
+    so IDs are globally unique without synchronizing on a shared counter
+    for every state. IDs in chunks that are not used up remain unused,
+    so size() is only an upper bound on the number of registered states
+    and iterating over the registry is not supported.
+
+    States that another thread registered can be looked up once the ID has
+    been passed to the current thread with proper synchronization (e.g.,
+    through a lock-protected queue). The initial state has to be
+    registered before several threads use the registry.
+
 
   ---------------
   Usage example 1
@@ -105,26 +157,67 @@
     The heuristic object uses an attribute of type PerStateBitset to store for each
     state and each landmark whether it was reached in this state.
 */
+namespace effect_packer {
+class EffectPacker;
+}
+
 namespace int_packer {
 class IntPacker;
 }
 
+namespace zobrist_hasher {
+class ZobristHasher;
+}
+
 using PackedStateBin = int_packer::IntPacker::Bin;
 
 
 class StateRegistry : public subscriber::SubscriberService<StateRegistry> {
+    using CompressibleStateDataPool =
+        segmented_vector::CompressibleSegmentedArrayVector<
+            PackedStateBin, utils::MappedFileAllocator<PackedStateBin>>;
+
+    /*
+      Return the data of the state with the given ID. Data of compressed
+      states is copied to the given buffer.
+    */
+    template<typename StateDataPool>
+    static const PackedStateBin *get_state_data(
+        const StateDataPool &state_data_pool, int id,
+        std::vector<PackedStateBin> &) {
+        return state_data_pool[id];
+    }
+
+    static const PackedStateBin *get_state_data(
+        const CompressibleStateDataPool &state_data_pool, int id,
+        std::vector<PackedStateBin> &buffer) {
+        if (!state_data_pool.is_compressed(id)) {
+            return state_data_pool[id];
+        }
+        state_data_pool.copy_array(id, buffer.data());
+        return buffer.data();
+    }
+
+    template<typename StateDataPool>
     struct StateIDSemanticHash {
-        const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool;
+        const StateDataPool &state_data_pool;
         int state_size;
-        StateIDSemanticHash(
-            const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool,
-            int state_size)
+        // With Zobrist hashing, the hash is stored in the bin after the state.
+        bool use_cached_hash;
+        mutable std::vector<PackedStateBin> buffer;
+        StateIDSemanticHash(const StateDataPool &state_data_pool, int state_size,
+                            bool use_cached_hash)
             : state_data_pool(state_data_pool),
-              state_size(state_size) {
+              state_size(state_size),
+              use_cached_hash(use_cached_hash),
+              buffer(state_size + (use_cached_hash ? 1 : 0)) {
         }
 
         int_hash_set::HashType operator()(int id) const {
-            const PackedStateBin *data = state_data_pool[id];
+            const PackedStateBin *data = get_state_data(state_data_pool, id, buffer);
+            if (use_cached_hash) {
+                return data[state_size];
+            }
             utils::HashState hash_state;
             for (int i = 0; i < state_size; ++i) {
                 hash_state.feed(data[i]);
@@ -133,19 +226,25 @@ class StateRegistry : public subscriber::SubscriberService<StateRegistry> {
         }
     };
 
+    template<typename StateDataPool>
     struct StateIDSemanticEqual {
-        const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool;
+        const StateDataPool &state_data_pool;
         int state_size;
-        StateIDSemanticEqual(
-            const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool,
-            int state_size)
+        mutable std::vector<PackedStateBin> lhs_buffer;
+        mutable std::vector<PackedStateBin> rhs_buffer;
+        StateIDSemanticEqual(const StateDataPool &state_data_pool, int state_size,
+                             int entry_size)
             : state_data_pool(state_data_pool),
-              state_size(state_size) {
+              state_size(state_size),
+              lhs_buffer(entry_size),
+              rhs_buffer(entry_size) {
         }
 
         bool operator()(int lhs, int rhs) const {
-            const PackedStateBin *lhs_data = state_data_pool[lhs];
-            const PackedStateBin *rhs_data = state_data_pool[rhs];
+            const PackedStateBin *lhs_data =
+                get_state_data(state_data_pool, lhs, lhs_buffer);
+            const PackedStateBin *rhs_data =
+                get_state_data(state_data_pool, rhs, rhs_buffer);
             return std::equal(lhs_data, lhs_data + state_size, rhs_data);
         }
     };
@@ -155,22 +254,64 @@ class StateRegistry : public subscriber::SubscriberService<StateRegistry> {
       this registry and find their IDs. States are compared/hashed semantically,
       i.e. the actual state data is compared, not the memory location.
     */
-    using StateIDSet = int_hash_set::IntHashSet<StateIDSemanticHash, StateIDSemanticEqual>;
+    using StateDataPool = CompressibleStateDataPool;
+    using StateIDSet = int_hash_set::IntHashSet<
+        StateIDSemanticHash<StateDataPool>, StateIDSemanticEqual<StateDataPool>>;
 
     TaskProxy task_proxy;
     const int_packer::IntPacker &state_packer;
+    const effect_packer::EffectPacker &effect_packer;
     AxiomEvaluator &axiom_evaluator;
+    // Only set if the registry uses Zobrist hashing.
+    const zobrist_hasher::ZobristHasher *zobrist_hasher;
     const int num_variables;
 
-    segmented_vector::SegmentedArrayVector<PackedStateBin> state_data_pool;
+    // Only set if state data is stored in a memory-mapped file.
+    std::shared_ptr<utils::MappedFilePool> mapped_file_pool;
+    StateDataPool state_data_pool;
     StateIDSet registered_states;
+    /*
+      Copy of registered_states.size() that may be read by other threads
+      while states are registered (e.g., by per-thread heuristic caches in
+      parallel search engines). In thread-safe registries, this is the
+      number of IDs that have been handed out to the threads instead.
+    */
+    std::atomic<std::size_t> num_registered_states;
 
     std::unique_ptr<State> cached_initial_state;
 
+    // Data of thread-safe registries; nullptr otherwise.
+    struct ConcurrentStorage;
+    std::unique_ptr<ConcurrentStorage> concurrent_storage;
+
     StateID insert_id_or_pop_state();
+    PackedStateBin *get_free_concurrent_slot();
+    StateID insert_concurrent_slot();
+    /*
+      Apply op to the given copy of the data of predecessor, writing only
+      the bins that the effects of op and the axioms change. Returns the
+      unpacked successor values for tasks with axioms and an empty vector
+      otherwise.
+    */
+    std::vector<int> apply_operator(
+        const State &predecessor, const OperatorProxy &op,
+        PackedStateBin *buffer);
+    State create_registered_state(
+        StateID id, const PackedStateBin *buffer, std::vector<int> &&values);
     int get_bins_per_state() const;
+    // Number of bins stored per state, including the cached hash.
+    int get_bins_per_entry() const;
 public:
-    explicit StateRegistry(const TaskProxy &task_proxy);
+    explicit StateRegistry(const TaskProxy &task_proxy, bool thread_safe = false,
+                           bool zobrist_hashing = false,
+                           bool compress_states = false,
+                           const std::shared_ptr<utils::MappedFilePool> &
+                           mapped_file_pool = nullptr);
+    ~StateRegistry();
+
+    bool is_thread_safe() const {
+        return concurrent_storage != nullptr;
+    }
 
     const TaskProxy &get_task_proxy() const {
         return task_proxy;
@@ -180,10 +321,22 @@ public:
         return num_variables;
     }
 
+    /*
+      Returns the Zobrist hash of the given state. The registry must use
+      Zobrist hashing. For states of this registry, the stored hash is
+      returned without computing it.
+    */
+    int_hash_set::HashType get_zobrist_hash(const State &state) const;
+
     const int_packer::IntPacker &get_state_packer() const {
         return state_packer;
     }
 
+    // Returns nullptr if the state data is not stored in a memory-mapped file.
+    const std::shared_ptr<utils::MappedFilePool> &get_mapped_file_pool() const {
+        return mapped_file_pool;
+    }
+
     /*
       Returns the state that was registered at the given ID. The ID must refer
       to a state in this registry. Do not mix IDs from from different registries.
@@ -204,14 +357,36 @@ public:
     State get_successor_state(const State &predecessor, const OperatorProxy &op);
 
     /*
-      Returns the number of states registered so far.
+      Returns the ID of the registered state with the given values or
+      StateID::no_state if there is none, without registering the state.
+      Not supported for thread-safe registries.
+    */
+    StateID find_state(const std::vector<int> &values);
+
+    /*
+      Returns the number of states registered so far. For thread-safe
+      registries, this is an upper bound (see above).
     */
     size_t size() const {
-        return registered_states.size();
+        return num_registered_states.load(std::memory_order_acquire);
     }
 
     int get_state_size_in_bytes() const;
 
+    /*
+      Remove all states except the given ones, which must be sorted by ID
+      and include the initial state. The remaining states keep their
+      order and get the IDs 0, 1, 2, ... All State objects and StateIDs of
+      this registry that were created before become invalid, except for
+      the initial state. Per-state information that subscribers store for
+      this registry is discarded as if the registry was destroyed. Not
+      supported for thread-safe registries.
+    */
+    void compact(const std::vector<StateID> &remaining_states);
+
+    // Memory used for the state data and the hash set (not per-state information).
+    std::size_t estimate_memory_in_bytes() const;
+
     void print_statistics(utils::LogProxy &log) const;
 
     class const_iterator : public std::iterator<
@@ -256,6 +431,7 @@ public:
     };
 
     const_iterator begin() const {
+        assert(!is_thread_safe());
         return const_iterator(*this, 0);
     }
 
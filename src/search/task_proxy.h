@@ -14,6 +14,7 @@
 #include <cassert>
 #include <cstddef>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -579,6 +580,12 @@ class State {
       semantics of the state".
     */
     mutable std::shared_ptr<std::vector<int>> values;
+    /*
+      Copy of the packed data that buffer points to. Registries that
+      compress their state data use it for states whose data they do not
+      keep at a fixed location (see StateRegistry).
+    */
+    std::shared_ptr<const std::vector<PackedStateBin>> owned_buffer;
     const int_packer::IntPacker *state_packer;
     int num_variables;
 public:
@@ -590,6 +597,9 @@ public:
     // Construct a registered state with packed and unpacked data.
     State(const AbstractTask &task, const StateRegistry &registry, StateID id,
           const PackedStateBin *buffer, std::vector<int> &&values);
+    // Construct a registered state that owns a copy of its packed data.
+    State(const AbstractTask &task, const StateRegistry &registry, StateID id,
+          std::shared_ptr<const std::vector<PackedStateBin>> &&owned_buffer);
     // Construct a state with only unpacked data.
     State(const AbstractTask &task, std::vector<int> &&values);
 
@@ -699,6 +709,13 @@ public:
         return State(*task, registry, id, buffer, std::move(state_values));
     }
 
+    // This method is meant to be called only by the state registry.
+    State create_state(
+        const StateRegistry &registry, StateID id,
+        std::shared_ptr<const std::vector<PackedStateBin>> &&owned_buffer) const {
+        return State(*task, registry, id, std::move(owned_buffer));
+    }
+
     State get_initial_state() const {
         return create_state(task->get_initial_state_values());
     }
@@ -784,16 +801,9 @@ inline void State::unpack() const {
           in the required size and then assigning values was faster than the
           more obvious reserve/push_back. Although, the benchmark did not
           profile this specific code.
-
-          We might consider a bulk-unpack method in state_packer that could be
-          more efficient. (One can imagine state packer to have extra data
-          structures that exploit sequentially unpacking each entry, by doing
-          things bin by bin.)
         */
         values = std::make_shared<std::vector<int>>(num_variables);
-        for (int var = 0; var < num_variables; ++var) {
-            (*values)[var] = state_packer->get(buffer, var);
-        }
+        state_packer->unpack(buffer, values->data());
     }
 }
 
@@ -0,0 +1,84 @@
+#include "effect_packer.h"
+
+#include "task_properties.h"
+
+#include "../task_proxy.h"
+
+#include <map>
+
+using namespace std;
+
+namespace effect_packer {
+EffectPacker::EffectPacker(const TaskProxy &task_proxy)
+    : state_packer(task_properties::g_state_packers[task_proxy]) {
+    OperatorsProxy operators = task_proxy.get_operators();
+    bin_effects_begin.reserve(operators.size() + 1);
+    conditional_effects_begin.reserve(operators.size() + 1);
+    for (OperatorProxy op : operators) {
+        bin_effects_begin.push_back(bin_effects.size());
+        conditional_effects_begin.push_back(conditional_effects.size());
+        EffectsProxy effects = op.get_effects();
+        bool has_conditional_effects = false;
+        for (EffectProxy effect : effects) {
+            if (!effect.get_conditions().empty()) {
+                has_conditional_effects = true;
+                break;
+            }
+        }
+        if (has_conditional_effects) {
+            /*
+              We keep all effects of the operator in their original order
+              to preserve the semantics of effects on the same variable.
+            */
+            for (EffectProxy effect : effects) {
+                vector<FactPair> conditions;
+                for (FactProxy condition : effect.get_conditions()) {
+                    conditions.push_back(condition.get_pair());
+                }
+                conditional_effects.emplace_back(
+                    move(conditions), effect.get_fact().get_pair());
+            }
+        } else {
+            // Combine the effects on variables in the same bin.
+            map<int, pair<Bin, Bin>> masks_and_bits_by_bin;
+            for (EffectProxy effect : effects) {
+                FactPair fact = effect.get_fact().get_pair();
+                int bin_index = state_packer.get_bin_index(fact.var);
+                Bin clear_mask = state_packer.get_clear_mask(fact.var);
+                auto result = masks_and_bits_by_bin.emplace(
+                    bin_index, make_pair(~Bin(0), Bin(0)));
+                pair<Bin, Bin> &masks_and_bits = result.first->second;
+                masks_and_bits.first &= clear_mask;
+                masks_and_bits.second =
+                    (masks_and_bits.second & clear_mask) |
+                    state_packer.get_value_bits(fact.var, fact.value);
+            }
+            for (const auto &entry : masks_and_bits_by_bin) {
+                bin_effects.emplace_back(
+                    entry.first, entry.second.first, entry.second.second);
+            }
+        }
+    }
+    bin_effects_begin.push_back(bin_effects.size());
+    conditional_effects_begin.push_back(conditional_effects.size());
+
+    for (VariableProxy var : task_proxy.get_variables()) {
+        if (var.is_derived()) {
+            derived_variables.push_back(var.get_id());
+        }
+    }
+}
+
+void EffectPacker::apply_conditional_effect(
+    const ConditionalEffect &effect, const Bin *predecessor_buffer,
+    Bin *successor_buffer) const {
+    for (const FactPair &condition : effect.conditions) {
+        if (state_packer.get(predecessor_buffer, condition.var) != condition.value) {
+            return;
+        }
+    }
+    state_packer.set(successor_buffer, effect.fact.var, effect.fact.value);
+}
+
+PerTaskInformation<EffectPacker> g_effect_packers;
+}
@@ -0,0 +1,97 @@
+#ifndef TASK_UTILS_EFFECT_PACKER_H
+#define TASK_UTILS_EFFECT_PACKER_H
+
+#include "../abstract_task.h"
+#include "../per_task_information.h"
+
+#include "../algorithms/int_packer.h"
+
+#include <utility>
+#include <vector>
+
+class TaskProxy;
+
+namespace effect_packer {
+/*
+  EffectPacker applies the effects of operators directly to packed state
+  data, i.e., without unpacking the predecessor or repacking the successor.
+
+  For every operator without conditional effects, we precompute the bins
+  that its effects touch, together with a mask that clears the affected
+  variables and the bits that encode the new values (see
+  IntPacker::get_value_bits). Applying the operator to a copy of the
+  packed predecessor then takes one read-modify-write per touched bin.
+  Operators with conditional effects keep the list of all their effects
+  and check the conditions on the packed predecessor.
+
+  Derived variables are not handled here. After applying the effects,
+  callers have to evaluate the axioms and write back the derived
+  variables, which are listed by get_derived_variables.
+*/
+class EffectPacker {
+    using Bin = int_packer::IntPacker::Bin;
+
+    struct BinEffect {
+        int bin_index;
+        Bin clear_mask;
+        Bin value_bits;
+
+        BinEffect(int bin_index, Bin clear_mask, Bin value_bits)
+            : bin_index(bin_index),
+              clear_mask(clear_mask),
+              value_bits(value_bits) {
+        }
+    };
+
+    struct ConditionalEffect {
+        std::vector<FactPair> conditions;
+        FactPair fact;
+
+        ConditionalEffect(std::vector<FactPair> &&conditions, const FactPair &fact)
+            : conditions(std::move(conditions)),
+              fact(fact) {
+        }
+    };
+
+    const int_packer::IntPacker &state_packer;
+    // The effects of operator i are in the range [begin[i], begin[i + 1]).
+    std::vector<BinEffect> bin_effects;
+    std::vector<int> bin_effects_begin;
+    std::vector<ConditionalEffect> conditional_effects;
+    std::vector<int> conditional_effects_begin;
+    std::vector<int> derived_variables;
+
+    void apply_conditional_effect(
+        const ConditionalEffect &effect, const Bin *predecessor_buffer,
+        Bin *successor_buffer) const;
+public:
+    explicit EffectPacker(const TaskProxy &task_proxy);
+
+    /*
+      Apply the effects of the given operator to successor_buffer, which
+      must hold a copy of predecessor_buffer.
+    */
+    void apply(int op_id, const Bin *predecessor_buffer,
+               Bin *successor_buffer) const {
+        for (int i = bin_effects_begin[op_id];
+             i < bin_effects_begin[op_id + 1]; ++i) {
+            const BinEffect &effect = bin_effects[i];
+            Bin &bin = successor_buffer[effect.bin_index];
+            bin = (bin & effect.clear_mask) | effect.value_bits;
+        }
+        for (int i = conditional_effects_begin[op_id];
+             i < conditional_effects_begin[op_id + 1]; ++i) {
+            apply_conditional_effect(
+                conditional_effects[i], predecessor_buffer, successor_buffer);
+        }
+    }
+
+    const std::vector<int> &get_derived_variables() const {
+        return derived_variables;
+    }
+};
+
+extern PerTaskInformation<EffectPacker> g_effect_packers;
+}
+
+#endif
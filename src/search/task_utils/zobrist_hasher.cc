@@ -0,0 +1,57 @@
+#include "zobrist_hasher.h"
+
+#include "task_properties.h"
+
+#include "../task_proxy.h"
+
+#include "../utils/collections.h"
+#include "../utils/rng.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+namespace zobrist_hasher {
+static const int KEY_SEED = 2022;
+
+ZobristHasher::ZobristHasher(const TaskProxy &task_proxy)
+    : state_packer(task_properties::g_state_packers[task_proxy]) {
+    utils::RandomNumberGenerator rng(KEY_SEED);
+    VariablesProxy variables = task_proxy.get_variables();
+    key_offsets.reserve(variables.size());
+    for (VariableProxy var : variables) {
+        key_offsets.push_back(keys.size());
+        for (int value = 0; value < var.get_domain_size(); ++value) {
+            keys.push_back((static_cast<uint32_t>(rng.random(1 << 16)) << 16) |
+                           static_cast<uint32_t>(rng.random(1 << 16)));
+        }
+        if (var.is_derived()) {
+            derived_variables.push_back(var.get_id());
+        }
+    }
+
+    OperatorsProxy operators = task_proxy.get_operators();
+    affected_variables_begin.reserve(operators.size() + 1);
+    for (OperatorProxy op : operators) {
+        affected_variables_begin.push_back(affected_variables.size());
+        vector<int> vars;
+        for (EffectProxy effect : op.get_effects()) {
+            vars.push_back(effect.get_fact().get_variable().get_id());
+        }
+        utils::sort_unique(vars);
+        affected_variables.insert(affected_variables.end(), vars.begin(), vars.end());
+    }
+    affected_variables_begin.push_back(affected_variables.size());
+}
+
+int_hash_set::HashType ZobristHasher::compute_hash(const Bin *buffer) const {
+    HashType hash = 0;
+    for (size_t var = 0; var < key_offsets.size(); ++var) {
+        hash ^= get_key(var, state_packer.get(buffer, var));
+    }
+    return hash;
+}
+
+PerTaskInformation<ZobristHasher> g_zobrist_hashers;
+}
@@ -0,0 +1,79 @@
+#ifndef TASK_UTILS_ZOBRIST_HASHER_H
+#define TASK_UTILS_ZOBRIST_HASHER_H
+
+#include "../per_task_information.h"
+
+#include "../algorithms/int_hash_set.h"
+#include "../algorithms/int_packer.h"
+
+#include <vector>
+
+class TaskProxy;
+
+namespace zobrist_hasher {
+/*
+  ZobristHasher computes Zobrist hashes of packed states: every fact has a
+  random key and the hash of a state is the XOR of the keys of its facts.
+
+  The main advantage over hashing the packed data is that the hash of a
+  successor can be derived from the hash of its predecessor by replacing
+  the keys of the variables that changed. We precompute for every
+  operator the variables that its effects affect, so updating the hash
+  costs time linear in the number of effects (plus the number of derived
+  variables for tasks with axioms) instead of the size of the state.
+
+  The keys are generated from a fixed seed, so the hashes of a state are
+  the same in all runs.
+*/
+class ZobristHasher {
+    using Bin = int_packer::IntPacker::Bin;
+    using HashType = int_hash_set::HashType;
+
+    const int_packer::IntPacker &state_packer;
+    // The key of fact (var, value) is keys[key_offsets[var] + value].
+    std::vector<HashType> keys;
+    std::vector<int> key_offsets;
+    // The variables affected by operator i are in the range [begin[i], begin[i + 1]).
+    std::vector<int> affected_variables;
+    std::vector<int> affected_variables_begin;
+    std::vector<int> derived_variables;
+
+    HashType get_key(int var, int value) const {
+        return keys[key_offsets[var] + value];
+    }
+
+    HashType get_key_change(
+        int var, const Bin *predecessor_buffer, const Bin *successor_buffer) const {
+        return get_key(var, state_packer.get(predecessor_buffer, var)) ^
+               get_key(var, state_packer.get(successor_buffer, var));
+    }
+public:
+    explicit ZobristHasher(const TaskProxy &task_proxy);
+
+    HashType compute_hash(const Bin *buffer) const;
+
+    /*
+      Return the hash of the state in successor_buffer, which must be the
+      result of applying the given operator (and the axioms) to the state
+      in predecessor_buffer, whose hash is predecessor_hash.
+    */
+    HashType compute_successor_hash(
+        HashType predecessor_hash, int op_id, const Bin *predecessor_buffer,
+        const Bin *successor_buffer) const {
+        HashType hash = predecessor_hash;
+        for (int i = affected_variables_begin[op_id];
+             i < affected_variables_begin[op_id + 1]; ++i) {
+            hash ^= get_key_change(
+                affected_variables[i], predecessor_buffer, successor_buffer);
+        }
+        for (int var : derived_variables) {
+            hash ^= get_key_change(var, predecessor_buffer, successor_buffer);
+        }
+        return hash;
+    }
+};
+
+extern PerTaskInformation<ZobristHasher> g_zobrist_hashers;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include "epsilon_greedy_selection.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../utils/rng.h"
+
+#include <cassert>
+#include <climits>
+
+using namespace std;
+
+namespace epsilon_greedy_selection {
+EpsilonGreedySelection::EpsilonGreedySelection(const Options &opts)
+    : epsilon(opts.get<double>("epsilon")) {
+}
+
+int EpsilonGreedySelection::choose_child(
+    const vector<SelectionCandidate> &candidates, int,
+    utils::RandomNumberGenerator &rng) const {
+    assert(!candidates.empty());
+    if (rng.random() < epsilon) {
+        return rng.random(candidates.size());
+    }
+
+    int min_h = INT_MAX;
+    int num_ties = 0;
+    for (const SelectionCandidate &candidate : candidates) {
+        if (candidate.best_h < min_h) {
+            min_h = candidate.best_h;
+            num_ties = 1;
+        } else if (candidate.best_h == min_h) {
+            ++num_ties;
+        }
+    }
+    int chosen_tie = rng.random(num_ties);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (candidates[i].best_h == min_h && chosen_tie-- == 0) {
+            return i;
+        }
+    }
+    assert(false);
+    return -1;
+}
+
+static shared_ptr<TreeSelectionPolicy> _parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Epsilon-greedy selection",
+        "Chooses a child uniformly at random with probability 'epsilon'. "
+        "Otherwise, it chooses uniformly at random among the children with "
+        "minimal best h value.");
+    parser.add_option<double>(
+        "epsilon",
+        "probability for choosing a random child",
+        "0.001",
+        Bounds("0.0", "1.0"));
+
+    Options opts = parser.parse();
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return make_shared<EpsilonGreedySelection>(opts);
+}
+
+static Plugin<TreeSelectionPolicy> _plugin("epsilon_greedy_selection", _parse);
+}
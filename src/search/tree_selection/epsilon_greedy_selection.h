@@ -0,0 +1,22 @@
+#ifndef TREE_SELECTION_EPSILON_GREEDY_SELECTION_H
+#define TREE_SELECTION_EPSILON_GREEDY_SELECTION_H
+
+#include "../tree_selection_policy.h"
+
+namespace options {
+class Options;
+}
+
+namespace epsilon_greedy_selection {
+class EpsilonGreedySelection : public TreeSelectionPolicy {
+    double epsilon;
+public:
+    explicit EpsilonGreedySelection(const options::Options &opts);
+
+    virtual int choose_child(
+        const std::vector<SelectionCandidate> &candidates, int parent_visits,
+        utils::RandomNumberGenerator &rng) const override;
+};
+}
+
+#endif
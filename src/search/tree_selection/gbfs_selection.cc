@@ -0,0 +1,41 @@
+#include "gbfs_selection.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include <cassert>
+
+using namespace std;
+
+namespace gbfs_selection {
+int GBFSSelection::choose_child(
+    const vector<SelectionCandidate> &candidates, int,
+    utils::RandomNumberGenerator &) const {
+    assert(!candidates.empty());
+    int best_index = 0;
+    for (size_t i = 1; i < candidates.size(); ++i) {
+        if (candidates[i].best_h < candidates[best_index].best_h) {
+            best_index = i;
+        }
+    }
+    return best_index;
+}
+
+static shared_ptr<TreeSelectionPolicy> _parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Greedy best-first selection",
+        "Always chooses the child with minimal best h value. Ties are "
+        "broken in favor of the child that comes first in the child list "
+        "of the node, which usually is the child that was generated "
+        "first. Since the best h value of a node is the minimal h value "
+        "of the open nodes below it, the search expands the nodes in the "
+        "same order as greedy best-first search, up to tie-breaking.");
+    parser.parse();
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return make_shared<GBFSSelection>();
+}
+
+static Plugin<TreeSelectionPolicy> _plugin("gbfs_selection", _parse);
+}
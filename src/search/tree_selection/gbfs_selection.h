@@ -0,0 +1,15 @@
+#ifndef TREE_SELECTION_GBFS_SELECTION_H
+#define TREE_SELECTION_GBFS_SELECTION_H
+
+#include "../tree_selection_policy.h"
+
+namespace gbfs_selection {
+class GBFSSelection : public TreeSelectionPolicy {
+public:
+    virtual int choose_child(
+        const std::vector<SelectionCandidate> &candidates, int parent_visits,
+        utils::RandomNumberGenerator &rng) const override;
+};
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include "softmin_selection.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../utils/rng.h"
+
+#include <cassert>
+#include <climits>
+#include <cmath>
+
+using namespace std;
+
+namespace softmin_selection {
+SoftminSelection::SoftminSelection(const Options &opts)
+    : temperature(opts.get<double>("temperature")) {
+}
+
+int SoftminSelection::choose_child(
+    const vector<SelectionCandidate> &candidates, int,
+    utils::RandomNumberGenerator &rng) const {
+    assert(!candidates.empty());
+    /*
+      Subtracting the minimal h value from all h values does not change
+      the distribution but keeps exp() from underflowing for large h
+      values. The candidate with minimal h value has weight 1, so the
+      total weight is positive.
+    */
+    int min_h = INT_MAX;
+    for (const SelectionCandidate &candidate : candidates) {
+        min_h = min(min_h, candidate.best_h);
+    }
+    double total_weight = 0;
+    for (const SelectionCandidate &candidate : candidates) {
+        total_weight += exp((min_h - candidate.best_h) / temperature);
+    }
+
+    // Sample a candidate with probability proportional to its weight.
+    double threshold = rng.random() * total_weight;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        threshold -= exp((min_h - candidates[i].best_h) / temperature);
+        if (threshold < 0) {
+            return i;
+        }
+    }
+    // Rounding errors may leave a small positive remainder.
+    return candidates.size() - 1;
+}
+
+static shared_ptr<TreeSelectionPolicy> _parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Softmin selection",
+        "Chooses each child with a probability that is proportional to "
+        "exp(-h / temperature), where h is the best h value of the child "
+        "(Boltzmann distribution). Low temperatures approach greedy "
+        "selection, high temperatures approach uniform selection.");
+    parser.add_option<double>(
+        "temperature",
+        "temperature of the Boltzmann distribution",
+        "1.0",
+        Bounds("0.001", "infinity"));
+
+    Options opts = parser.parse();
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return make_shared<SoftminSelection>(opts);
+}
+
+static Plugin<TreeSelectionPolicy> _plugin("softmin_selection", _parse);
+}
@@ -0,0 +1,86 @@
+#include "uct_selection.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../utils/rng.h"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace uct_selection {
+UCTSelection::UCTSelection(const Options &opts)
+    : exploration_weight(opts.get<double>("c")) {
+}
+
+int UCTSelection::choose_child(
+    const vector<SelectionCandidate> &candidates, int parent_visits,
+    utils::RandomNumberGenerator &rng) const {
+    assert(!candidates.empty());
+    /*
+      We normalize the average h values of the candidates to [0, 1] by
+      dividing by their maximum, so that the exploration weight does not
+      depend on the scale of the heuristic.
+    */
+    double max_average_h = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (candidates[i].num_visits == 0) {
+            return i;
+        }
+        max_average_h = max(max_average_h, candidates[i].average_h);
+    }
+    double log_parent_visits = log(max(parent_visits, 1));
+
+    double min_score = numeric_limits<double>::infinity();
+    int num_ties = 0;
+    int chosen_index = -1;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const SelectionCandidate &candidate = candidates[i];
+        double value = (max_average_h > 0) ?
+            candidate.average_h / max_average_h : 0;
+        double score = value - exploration_weight *
+            sqrt(log_parent_visits / candidate.num_visits);
+        if (score < min_score) {
+            min_score = score;
+            num_ties = 1;
+            chosen_index = i;
+        } else if (score == min_score) {
+            // Reservoir sampling breaks ties uniformly at random.
+            ++num_ties;
+            if (rng.random(num_ties) == 0) {
+                chosen_index = i;
+            }
+        }
+    }
+    assert(chosen_index != -1);
+    return chosen_index;
+}
+
+static shared_ptr<TreeSelectionPolicy> _parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "UCT selection",
+        "Chooses the child that minimizes "
+        "avg_h / max_avg_h - c * sqrt(ln(N) / n), where avg_h is the "
+        "average h value of all nodes that were evaluated below the child, "
+        "max_avg_h is the maximal avg_h among the children, N is the visit "
+        "count of the node and n the visit count of the child. Children "
+        "that were not visited yet are chosen first. Ties are broken "
+        "uniformly at random.");
+    parser.add_option<double>(
+        "c",
+        "exploration weight",
+        "1.414",
+        Bounds("0.0", "infinity"));
+
+    Options opts = parser.parse();
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return make_shared<UCTSelection>(opts);
+}
+
+static Plugin<TreeSelectionPolicy> _plugin("uct_selection", _parse);
+}
@@ -0,0 +1,22 @@
+#ifndef TREE_SELECTION_UCT_SELECTION_H
+#define TREE_SELECTION_UCT_SELECTION_H
+
+#include "../tree_selection_policy.h"
+
+namespace options {
+class Options;
+}
+
+namespace uct_selection {
+class UCTSelection : public TreeSelectionPolicy {
+    double exploration_weight;
+public:
+    explicit UCTSelection(const options::Options &opts);
+
+    virtual int choose_child(
+        const std::vector<SelectionCandidate> &candidates, int parent_visits,
+        utils::RandomNumberGenerator &rng) const override;
+};
+}
+
+#endif
@@ -0,0 +1,8 @@
+#include "tree_selection_policy.h"
+
+#include "plugin.h"
+
+static PluginTypePlugin<TreeSelectionPolicy> _type_plugin(
+    "TreeSelectionPolicy",
+    "Choose the child of a node that a tree search (such as mcts) "
+    "descends to when selecting the next node to expand.");
@@ -0,0 +1,50 @@
+#ifndef TREE_SELECTION_POLICY_H
+#define TREE_SELECTION_POLICY_H
+
+#include "state_id.h"
+
+#include <vector>
+
+namespace utils {
+class RandomNumberGenerator;
+}
+
+/*
+  A child of a tree search node that may be selected, together with the
+  statistics that selection policies base their decision on. Tree
+  searches with several threads already add the virtual loss of the child
+  to the h values and the visit count.
+*/
+struct SelectionCandidate {
+    StateID id;
+    int best_h;
+    double average_h;
+    int num_visits;
+
+    SelectionCandidate(StateID id, int best_h, double average_h, int num_visits)
+        : id(id), best_h(best_h), average_h(average_h), num_visits(num_visits) {
+    }
+};
+
+/*
+  A TreeSelectionPolicy decides which child of a node a tree search
+  descends to when it walks from the root to the next node to expand.
+
+  Policies may be shared by several threads, so choose_child must not
+  modify the policy. All random decisions use the given generator.
+*/
+class TreeSelectionPolicy {
+public:
+    virtual ~TreeSelectionPolicy() = default;
+
+    /*
+      Return the index of the chosen element of candidates, which must not
+      be empty. parent_visits is the visit count of the node whose
+      children the candidates are.
+    */
+    virtual int choose_child(
+        const std::vector<SelectionCandidate> &candidates, int parent_visits,
+        utils::RandomNumberGenerator &rng) const = 0;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "treesearch_child_arena.h"
+
+#include "utils/logging.h"
+
+#include <algorithm>
+
+using namespace std;
+
+TreeChildArena::TreeChildArena()
+    : num_abandoned_slots(0) {
+}
+
+void TreeChildArena::grow_block(StateIDBlock &block) {
+    size_t block_end = block.offset + block.capacity;
+    if (block.capacity == 0 || block_end == slots.size()) {
+        // The block is the last one in the arena: extend it in place.
+        if (block.capacity == 0) {
+            block.offset = slots.size();
+        }
+        slots.push_back(StateID::no_state);
+        ++block.capacity;
+    } else {
+        int new_offset = slots.size();
+        int new_capacity = 2 * block.capacity;
+        slots.resize(slots.size() + new_capacity, StateID::no_state);
+        copy(slots.begin() + block.offset,
+             slots.begin() + block.offset + block.size,
+             slots.begin() + new_offset);
+        fill(slots.begin() + block.offset,
+             slots.begin() + block_end, StateID::no_state);
+        num_abandoned_slots += block.capacity;
+        block.offset = new_offset;
+        block.capacity = new_capacity;
+    }
+}
+
+StateIDSpan TreeChildArena::get_children(const StateIDBlock &block) const {
+    const StateID *first = slots.data() + block.offset;
+    return StateIDSpan(first, first + block.size);
+}
+
+bool TreeChildArena::contains_child(
+    const StateIDBlock &block, StateID child) const {
+    StateIDSpan children = get_children(block);
+    return find(children.begin(), children.end(), child) != children.end();
+}
+
+void TreeChildArena::add_child(StateIDBlock &block, StateID child) {
+    assert(child != StateID::no_state);
+    if (block.size == block.capacity) {
+        grow_block(block);
+    }
+    assert(block.size < block.capacity);
+    slots[block.offset + block.size] = child;
+    ++block.size;
+}
+
+void TreeChildArena::remove_child(StateIDBlock &block, StateID child) {
+    auto first = slots.begin() + block.offset;
+    auto last = first + block.size;
+    auto pos = find(first, last, child);
+    if (pos == last) {
+        return;
+    }
+    *pos = *(last - 1);
+    *(last - 1) = StateID::no_state;
+    --block.size;
+}
+
+void TreeChildArena::release_block(StateIDBlock &block) {
+    fill(slots.begin() + block.offset,
+         slots.begin() + block.offset + block.capacity, StateID::no_state);
+    num_abandoned_slots += block.capacity;
+    block = StateIDBlock();
+}
+
+void TreeChildArena::copy_block_to(
+    StateIDBlock &block, TreeChildArena &target,
+    const vector<int> &new_ids) const {
+    StateIDBlock new_block;
+    new_block.offset = target.slots.size();
+    for (StateID id : get_children(block)) {
+        if (!new_ids.empty()) {
+            assert(new_ids[id.value] != -1);
+            id = StateID(new_ids[id.value]);
+        }
+        target.slots.push_back(id);
+    }
+    new_block.size = block.size;
+    new_block.capacity = block.size;
+    if (new_block.capacity == 0) {
+        new_block.offset = 0;
+    }
+    block = new_block;
+}
+
+void TreeChildArena::shrink_to_fit() {
+    slots.shrink_to_fit();
+}
+
+size_t TreeChildArena::estimate_memory_in_bytes() const {
+    return slots.capacity() * sizeof(StateID);
+}
+
+void TreeChildArena::print_statistics(
+    utils::LogProxy &log, const string &name) const {
+    log << name << " slots: " << slots.size() << endl;
+    log << name << " abandoned slots: " << num_abandoned_slots << endl;
+    log << name << " memory: " << estimate_memory_in_bytes() / 1024
+        << " KB" << endl;
+}
@@ -0,0 +1,123 @@
+#ifndef TREESEARCH_CHILD_ARENA_H
+#define TREESEARCH_CHILD_ARENA_H
+
+#include "state_id.h"
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace utils {
+class LogProxy;
+}
+
+/*
+  Read-only view of a contiguous range of StateIDs. A span does not own
+  its data and is invalidated by every call that adds children to the
+  arena it was obtained from.
+*/
+class StateIDSpan {
+    const StateID *first;
+    const StateID *last;
+public:
+    StateIDSpan(const StateID *first, const StateID *last)
+        : first(first), last(last) {
+    }
+
+    const StateID *begin() const {
+        return first;
+    }
+
+    const StateID *end() const {
+        return last;
+    }
+
+    std::size_t size() const {
+        return last - first;
+    }
+
+    bool empty() const {
+        return first == last;
+    }
+
+    StateID operator[](std::size_t index) const {
+        assert(index < size());
+        return first[index];
+    }
+};
+
+/*
+  Location of the block of slots that one node owns in a TreeChildArena.
+  Only the first size slots are in use.
+*/
+struct StateIDBlock {
+    int offset;
+    int size;
+    int capacity;
+
+    StateIDBlock()
+        : offset(0), size(0), capacity(0) {
+    }
+};
+
+/*
+  TreeChildArena stores lists of StateIDs for all nodes of a tree search
+  in a single vector, usually the child lists. Every node owns one block
+  of slots in this vector, described by a StateIDBlock in its
+  TreeSearchNodeInfo.
+
+  Blocks only ever grow at the end of the arena: if the block of a node
+  is the last one, it is extended in place. Otherwise, it is moved to the
+  end of the arena with twice its previous capacity and the old block is
+  abandoned. Since nodes usually receive all their children in one
+  expansion, the common case is in-place growth without any slack.
+
+  Removing a child moves the last child of the block into its slot and
+  overwrites the vacated slot with a tombstone (StateID::no_state). The
+  slot stays reserved for the node, so a later add_child reuses it.
+  Abandoned slots are only reclaimed by copying all blocks into a new
+  arena (see copy_block_to).
+*/
+class TreeChildArena {
+    std::vector<StateID> slots;
+    // Number of slots in blocks that have been abandoned by relocation.
+    std::size_t num_abandoned_slots;
+
+    void grow_block(StateIDBlock &block);
+public:
+    TreeChildArena();
+
+    StateIDSpan get_children(const StateIDBlock &block) const;
+    bool contains_child(const StateIDBlock &block, StateID child) const;
+    void add_child(StateIDBlock &block, StateID child);
+    void remove_child(StateIDBlock &block, StateID child);
+    // Abandon the slots of the given block and make it empty.
+    void release_block(StateIDBlock &block);
+    /*
+      Append the IDs in the given block to the target arena, mapping every
+      ID to new_ids[ID] unless new_ids is empty, and make the block refer
+      to the copy. Copying the blocks of all nodes into an empty arena
+      yields an arena without slack and abandoned slots.
+    */
+    void copy_block_to(StateIDBlock &block, TreeChildArena &target,
+                       const std::vector<int> &new_ids) const;
+    void shrink_to_fit();
+
+    std::size_t get_num_slots() const {
+        return slots.size();
+    }
+
+    std::size_t get_num_abandoned_slots() const {
+        return num_abandoned_slots;
+    }
+
+    std::size_t estimate_memory_in_bytes() const;
+    /*
+      Print statistics, each prefixed with the given name of the lists
+      stored in the arena (e.g., "Child arena").
+    */
+    void print_statistics(utils::LogProxy &log, const std::string &name) const;
+};
+
+#endif
@@ -2,24 +2,28 @@
 #define TREESEARCH_NODE_INFO_H
 
 #include "operator_id.h"
-#include "state_id.h"
-#include "search_node_info.h"
+#include "treesearch_child_arena.h"
 
-#include <vector>
+/*
+  Per-node data of a tree search that is not needed when choosing among
+  the children of a node. The data that selection and back-propagation
+  scan (status, best_h, parent, real_g and the selection statistics) is
+  stored in separate dense arrays of the TreeSearchSpace.
 
-using namespace std;
-
-struct TreeSearchNodeInfo : public SearchNodeInfo{
-    int best_h;
-    vector<StateID> children_state_ids;
-    
+  The children of a node are not stored in the node info itself but in
+  the TreeChildArena of the TreeSearchSpace. The info only records where
+  its block of child IDs starts, how many of the slots are in use and
+  how many slots are reserved for the block. In DAG mode, the parents of
+  a node other than the one stored in the TreeSearchSpace are stored in
+  a second arena in the same way.
+*/
+struct TreeSearchNodeInfo {
+    int g;
+    OperatorID creating_operator;
+    StateIDBlock children;
+    StateIDBlock extra_parents;
 
     TreeSearchNodeInfo();
-
-    public:
-    StateID get_parent();
-    OperatorID get_operator();
-    void remove_child(StateID id);
 };
 
 #endif
@@ -1,38 +1,44 @@
 #include "treesearch_space.h"
-#include "search_space.h"
 
-#include "treesearch_node_info.h"
+#include "state_registry.h"
 #include "task_proxy.h"
 
 #include "task_utils/task_properties.h"
 #include "utils/logging.h"
 
+#include <algorithm>
 #include <cassert>
 
 using namespace std;
 
-TreeSearchNode::TreeSearchNode(const State &tstate, TreeSearchNodeInfo &tinfo) :
-    state(tstate), info(tinfo){
-    }
+TreeSearchNode::TreeSearchNode(
+    TreeSearchSpace &space, StateID id, TreeSearchNodeInfo &info)
+    : space(space), id(id), info(info) {
+    assert(id != StateID::no_state);
+}
+
+StateID TreeSearchNode::get_id() const {
+    return id;
+}
 
-const State &TreeSearchNode::get_state() const {
-    return state;
+State TreeSearchNode::get_state() const {
+    return space.state_registry.lookup_state(id);
 }
 
 bool TreeSearchNode::is_open() const {
-    return info.status == TreeSearchNodeInfo::OPEN;
+    return space.statuses[id.value] == SearchNodeInfo::OPEN;
 }
 
 bool TreeSearchNode::is_closed() const {
-    return info.status == TreeSearchNodeInfo::CLOSED;
+    return space.statuses[id.value] == SearchNodeInfo::CLOSED;
 }
 
 bool TreeSearchNode::is_dead_end() const {
-    return info.status == TreeSearchNodeInfo::DEAD_END;
+    return space.statuses[id.value] == SearchNodeInfo::DEAD_END;
 }
 
 bool TreeSearchNode::is_new() const {
-    return info.status == TreeSearchNodeInfo::NEW;
+    return space.statuses[id.value] == SearchNodeInfo::NEW;
 }
 
 int TreeSearchNode::get_g() const {
@@ -41,157 +47,297 @@ int TreeSearchNode::get_g() const {
 }
 
 int TreeSearchNode::get_real_g() const {
-    return info.real_g;
+    return space.real_g_values[id.value];
 }
 
-vector<StateID> TreeSearchNode::get_children(){
-    return info.children_state_ids;
+StateIDSpan TreeSearchNode::get_children() const {
+    return space.child_arena.get_children(info.children);
 }
 
-void TreeSearchNode::add_child(StateID &childID){
-    bool not_found = find(info.children_state_ids.begin(),info.children_state_ids.end(),childID) == info.children_state_ids.end();
-    if(not_found && info.get_parent() != childID){
-        info.children_state_ids.push_back(childID);
+bool TreeSearchNode::add_child(StateID child_id) {
+    if (get_parent() != child_id &&
+        !space.child_arena.contains_child(info.children, child_id)) {
+        space.child_arena.add_child(info.children, child_id);
+        return true;
     }
+    return false;
+}
+
+StateIDSpan TreeSearchNode::get_extra_parents() const {
+    return space.extra_parent_arena.get_children(info.extra_parents);
+}
+
+void TreeSearchNode::add_extra_parent(StateID parent_id) {
+    if (get_parent() != parent_id &&
+        !space.extra_parent_arena.contains_child(info.extra_parents, parent_id)) {
+        space.extra_parent_arena.add_child(info.extra_parents, parent_id);
+    }
+}
+
+void TreeSearchNode::remove_extra_parent(StateID parent_id) {
+    space.extra_parent_arena.remove_child(info.extra_parents, parent_id);
 }
 
 void TreeSearchNode::open_initial(int h) {
-    assert(info.status == TreeSearchNodeInfo::NEW);
-    info.status = TreeSearchNodeInfo::OPEN;
+    assert(is_new());
+    space.statuses[id.value] = SearchNodeInfo::OPEN;
     info.g = 0;
-    info.real_g = 0;
-    info.parent_state_id = StateID::no_state;
+    space.real_g_values[id.value] = 0;
+    space.parents[id.value] = StateID::no_state;
     info.creating_operator = OperatorID::no_operator;
-    info.best_h = h;
+    space.best_h_values[id.value] = h;
 }
 
 void TreeSearchNode::open(const TreeSearchNode &parent_node,
-                      const OperatorProxy &parent_op,
-                      int adjusted_cost) {
-    assert(info.status == TreeSearchNodeInfo::NEW);
-    info.status = TreeSearchNodeInfo::OPEN;
-    info.g = parent_node.info.g + adjusted_cost;
-    info.real_g = parent_node.info.real_g + parent_op.get_cost();
-    info.parent_state_id = parent_node.get_state().get_id();
-    info.creating_operator = OperatorID(parent_op.get_id());
+                          const OperatorProxy &parent_op,
+                          int adjusted_cost, int h) {
+    assert(is_new());
+    space.statuses[id.value] = SearchNodeInfo::OPEN;
+    space.best_h_values[id.value] = h;
+    update_parent(parent_node, parent_op, adjusted_cost);
 }
 
-void TreeSearchNode::update_g(int g_diff){
-    info.real_g = info.real_g - g_diff;
+void TreeSearchNode::update_g(int g_diff) {
+    space.real_g_values[id.value] -= g_diff;
 }
 
 void TreeSearchNode::reopen(const TreeSearchNode &parent_node,
-                        const OperatorProxy &parent_op,
-                        int adjusted_cost) {
-    assert(info.status == TreeSearchNodeInfo::OPEN ||
-           info.status == TreeSearchNodeInfo::CLOSED);
+                            const OperatorProxy &parent_op,
+                            int adjusted_cost) {
+    assert(is_open() || is_closed());
 
     // The latter possibility is for inconsistent heuristics, which
     // may require reopening closed nodes.
-    info.status = TreeSearchNodeInfo::OPEN;
-    info.g = parent_node.info.g + adjusted_cost;
-    info.real_g = parent_node.info.real_g + parent_op.get_cost();
-    info.parent_state_id = parent_node.get_state().get_id();
-    info.creating_operator = OperatorID(parent_op.get_id());
+    space.statuses[id.value] = SearchNodeInfo::OPEN;
+    update_parent(parent_node, parent_op, adjusted_cost);
 }
 
 // like reopen, except doesn't change status
 void TreeSearchNode::update_parent(const TreeSearchNode &parent_node,
-                               const OperatorProxy &parent_op,
-                               int adjusted_cost) {
-    assert(info.status == TreeSearchNodeInfo::OPEN ||
-           info.status == TreeSearchNodeInfo::CLOSED);
-    // The latter possibility is for inconsistent heuristics, which
-    // may require reopening closed nodes.
+                                   const OperatorProxy &parent_op,
+                                   int adjusted_cost) {
+    assert(is_open() || is_closed());
     info.g = parent_node.info.g + adjusted_cost;
-    info.real_g = parent_node.info.real_g + parent_op.get_cost();
-    info.parent_state_id = parent_node.get_state().get_id();
+    space.real_g_values[id.value] =
+        parent_node.get_real_g() + parent_op.get_cost();
+    space.parents[id.value] = parent_node.get_id();
     info.creating_operator = OperatorID(parent_op.get_id());
 }
-StateID TreeSearchNode::get_parent(){
-    return info.get_parent();
+
+StateID TreeSearchNode::get_parent() const {
+    return space.parents[id.value];
 }
 
-OperatorID TreeSearchNode::get_operator(){
-    return info.get_operator();
+OperatorID TreeSearchNode::get_operator() const {
+    return info.creating_operator;
 }
 
 void TreeSearchNode::close() {
-    assert(info.status == TreeSearchNodeInfo::OPEN);
-    info.status = TreeSearchNodeInfo::CLOSED;
+    assert(is_open());
+    space.statuses[id.value] = SearchNodeInfo::CLOSED;
 }
 
 void TreeSearchNode::mark_as_dead_end() {
-    info.status = TreeSearchNodeInfo::DEAD_END;
+    space.statuses[id.value] = SearchNodeInfo::DEAD_END;
 }
 
 void TreeSearchNode::dump(const TaskProxy &task_proxy, utils::LogProxy &log) const {
-    log << state.get_id() << ": ";
-    task_properties::dump_fdr(state);
+    log << id << ": ";
+    task_properties::dump_fdr(get_state());
     if (info.creating_operator != OperatorID::no_operator) {
         OperatorsProxy operators = task_proxy.get_operators();
         OperatorProxy op = operators[info.creating_operator.get_index()];
         log << " created by " << op.get_name()
-            << " from " << info.parent_state_id << endl;
+            << " from " << get_parent() << endl;
     } else {
         log << " no parent" << endl;
     }
 }
 
-void TreeSearchNode::remove_child(StateID id){
-    //cout << info.children_state_ids << endl;
-    info.remove_child(id);
-    //cout << info.children_state_ids<<"  after" << endl;
+void TreeSearchNode::remove_child(StateID child_id) {
+    space.child_arena.remove_child(info.children, child_id);
 }
 
-int TreeSearchNode::get_best_h(){
-    return info.best_h;
+int TreeSearchNode::get_best_h() const {
+    return space.best_h_values[id.value];
 }
 
-void TreeSearchNode::set_best_h(int new_best_h){
-    info.best_h = new_best_h;
+void TreeSearchNode::set_best_h(int new_best_h) {
+    space.best_h_values[id.value] = new_best_h;
 }
 
 TreeSearchSpace::TreeSearchSpace(StateRegistry &state_registry, utils::LogProxy &log)
     : state_registry(state_registry), log(log) {
 }
 
+void TreeSearchSpace::resize_to_registry() {
+    size_t num_states = state_registry.size();
+    statuses.resize(num_states, SearchNodeInfo::NEW);
+    best_h_values.resize(num_states, -1);
+    parents.resize(num_states, StateID::no_state);
+    real_g_values.resize(num_states, -1);
+    virtual_losses.resize(num_states, 0);
+    visit_counts.resize(num_states, 0);
+    average_h_values.resize(num_states, 0);
+    node_infos.resize(num_states);
+}
+
 TreeSearchNode TreeSearchSpace::get_node(const State &state) {
-    return TreeSearchNode(state, search_node_infos[state]);
+    assert(state.get_registry() == &state_registry);
+    return get_node(state.get_id());
+}
+
+TreeSearchNode TreeSearchSpace::get_node(StateID id) {
+    if (static_cast<size_t>(id.value) >= statuses.size()) {
+        resize_to_registry();
+    }
+    return TreeSearchNode(*this, id, node_infos[id.value]);
 }
- 
+
 void TreeSearchSpace::trace_path(const State &goal_state,
-                             vector<OperatorID> &path) const {
-    State current_state = goal_state;
-    assert(current_state.get_registry() == &state_registry);
+                                 vector<OperatorID> &path) const {
+    assert(goal_state.get_registry() == &state_registry);
     assert(path.empty());
+    StateID current_id = goal_state.get_id();
     for (;;) {
-        //cout << "trace" << current_state.get_id() << endl;
-        const TreeSearchNodeInfo &info = search_node_infos[current_state];
+        const TreeSearchNodeInfo &info = node_infos[current_id.value];
         if (info.creating_operator == OperatorID::no_operator) {
-            assert(info.parent_state_id == StateID::no_state);
+            assert(get_parent(current_id) == StateID::no_state);
             break;
         }
         path.push_back(info.creating_operator);
-        current_state = state_registry.lookup_state(info.parent_state_id);
+        current_id = get_parent(current_id);
     }
     reverse(path.begin(), path.end());
 }
 
+int TreeSearchSpace::collapse(StateID id) {
+    assert(removal_stack.empty());
+    TreeSearchNodeInfo &info = node_infos[id.value];
+    for (StateID child_id : child_arena.get_children(info.children)) {
+        removal_stack.push_back(child_id);
+    }
+    child_arena.release_block(info.children);
+    if (statuses[id.value] == SearchNodeInfo::CLOSED) {
+        statuses[id.value] = SearchNodeInfo::OPEN;
+    }
+
+    int num_removed = 0;
+    while (!removal_stack.empty()) {
+        StateID removed_id = removal_stack.back();
+        removal_stack.pop_back();
+        TreeSearchNodeInfo &removed_info = node_infos[removed_id.value];
+        for (StateID child_id : child_arena.get_children(removed_info.children)) {
+            removal_stack.push_back(child_id);
+        }
+        child_arena.release_block(removed_info.children);
+        assert(removed_info.extra_parents.size == 0);
+        assert(virtual_losses[removed_id.value] == 0);
+        removed_info = TreeSearchNodeInfo();
+        statuses[removed_id.value] = SearchNodeInfo::NEW;
+        best_h_values[removed_id.value] = -1;
+        parents[removed_id.value] = StateID::no_state;
+        real_g_values[removed_id.value] = -1;
+        visit_counts[removed_id.value] = 0;
+        average_h_values[removed_id.value] = 0;
+        ++num_removed;
+    }
+    return num_removed;
+}
+
+size_t TreeSearchSpace::count_nodes() const {
+    return statuses.size() -
+           count(statuses.begin(), statuses.end(), SearchNodeInfo::NEW);
+}
+
+void TreeSearchSpace::compact(bool compact_registry) {
+    // Maps old to new IDs if nodes are renumbered and is empty otherwise.
+    vector<int> new_ids;
+    size_t num_nodes = statuses.size();
+    if (compact_registry) {
+        vector<StateID> remaining_states;
+        new_ids.assign(statuses.size(), -1);
+        for (size_t i = 0; i < statuses.size(); ++i) {
+            if (statuses[i] != SearchNodeInfo::NEW) {
+                new_ids[i] = remaining_states.size();
+                remaining_states.push_back(StateID(i));
+            }
+        }
+        state_registry.compact(remaining_states);
+
+        num_nodes = remaining_states.size();
+        for (size_t new_id = 0; new_id < num_nodes; ++new_id) {
+            int old_id = remaining_states[new_id].value;
+            StateID parent_id = parents[old_id];
+            statuses[new_id] = statuses[old_id];
+            best_h_values[new_id] = best_h_values[old_id];
+            parents[new_id] = (parent_id == StateID::no_state) ?
+                StateID::no_state : StateID(new_ids[parent_id.value]);
+            real_g_values[new_id] = real_g_values[old_id];
+            virtual_losses[new_id] = virtual_losses[old_id];
+            visit_counts[new_id] = visit_counts[old_id];
+            average_h_values[new_id] = average_h_values[old_id];
+            node_infos[new_id] = node_infos[old_id];
+        }
+        statuses.resize(num_nodes);
+        statuses.shrink_to_fit();
+        best_h_values.resize(num_nodes);
+        best_h_values.shrink_to_fit();
+        parents.resize(num_nodes, StateID::no_state);
+        parents.shrink_to_fit();
+        real_g_values.resize(num_nodes);
+        real_g_values.shrink_to_fit();
+        virtual_losses.resize(num_nodes);
+        virtual_losses.shrink_to_fit();
+        visit_counts.resize(num_nodes);
+        visit_counts.shrink_to_fit();
+        average_h_values.resize(num_nodes);
+        average_h_values.shrink_to_fit();
+        node_infos.resize(num_nodes);
+        node_infos.shrink_to_fit();
+    }
+
+    TreeChildArena new_child_arena;
+    TreeChildArena new_extra_parent_arena;
+    for (size_t id = 0; id < num_nodes; ++id) {
+        TreeSearchNodeInfo &info = node_infos[id];
+        child_arena.copy_block_to(info.children, new_child_arena, new_ids);
+        extra_parent_arena.copy_block_to(
+            info.extra_parents, new_extra_parent_arena, new_ids);
+    }
+    new_child_arena.shrink_to_fit();
+    new_extra_parent_arena.shrink_to_fit();
+    child_arena = move(new_child_arena);
+    extra_parent_arena = move(new_extra_parent_arena);
+}
+
+size_t TreeSearchSpace::estimate_memory_in_bytes() const {
+    return statuses.capacity() * sizeof(uint8_t) +
+           best_h_values.capacity() * sizeof(int) +
+           parents.capacity() * sizeof(StateID) +
+           real_g_values.capacity() * sizeof(int) +
+           virtual_losses.capacity() * sizeof(int) +
+           visit_counts.capacity() * sizeof(int) +
+           average_h_values.capacity() * sizeof(float) +
+           node_infos.size() * sizeof(TreeSearchNodeInfo) +
+           child_arena.estimate_memory_in_bytes() +
+           extra_parent_arena.estimate_memory_in_bytes();
+}
+
 void TreeSearchSpace::dump(const TaskProxy &task_proxy) const {
     OperatorsProxy operators = task_proxy.get_operators();
     for (StateID id : state_registry) {
-        /* The body duplicates SearchNode::dump() but we cannot create
+        /* The body duplicates TreeSearchNode::dump() but we cannot create
            a search node without discarding the const qualifier. */
         State state = state_registry.lookup_state(id);
-        const TreeSearchNodeInfo &node_info = search_node_infos[state];
         log << id << ": ";
         task_properties::dump_fdr(state);
-        if (node_info.creating_operator != OperatorID::no_operator &&
-            node_info.parent_state_id != StateID::no_state) {
-            OperatorProxy op = operators[node_info.creating_operator.get_index()];
+        if (static_cast<size_t>(id.value) < statuses.size() &&
+            node_infos[id.value].creating_operator != OperatorID::no_operator &&
+            get_parent(id) != StateID::no_state) {
+            OperatorProxy op = operators[node_infos[id.value].creating_operator.get_index()];
             log << " created by " << op.get_name()
-                << " from " << node_info.parent_state_id << endl;
+                << " from " << get_parent(id) << endl;
         } else {
             log << "has no parent" << endl;
         }
@@ -200,4 +346,19 @@ void TreeSearchSpace::dump(const TaskProxy &task_proxy) const {
 
 void TreeSearchSpace::print_statistics() const {
     state_registry.print_statistics(log);
+    size_t num_open = count(
+        statuses.begin(), statuses.end(), SearchNodeInfo::OPEN);
+    size_t num_closed = count(
+        statuses.begin(), statuses.end(), SearchNodeInfo::CLOSED);
+    size_t num_dead_ends = count(
+        statuses.begin(), statuses.end(), SearchNodeInfo::DEAD_END);
+    log << "Tree nodes: " << num_open + num_closed + num_dead_ends
+        << " (open: " << num_open << ", closed: " << num_closed
+        << ", dead ends: " << num_dead_ends << ")" << endl;
+    child_arena.print_statistics(log, "Child arena");
+    if (extra_parent_arena.get_num_slots() > 0) {
+        extra_parent_arena.print_statistics(log, "Extra parent arena");
+    }
+    log << "Tree search space memory: "
+        << estimate_memory_in_bytes() / 1024 << " KB" << endl;
 }
@@ -2,27 +2,41 @@
 #define TREESEARCH_SPACE_H
 
 #include "operator_cost.h"
-#include "per_state_information.h"
-#include "treesearch_node_info.h"
 #include "search_node_info.h"
-#include "search_space.h"
+#include "state_id.h"
+#include "treesearch_child_arena.h"
+#include "treesearch_node_info.h"
 
+#include "algorithms/segmented_vector.h"
+
+#include <cassert>
+#include <cstdint>
 #include <vector>
 
 class OperatorProxy;
 class State;
+class StateRegistry;
 class TaskProxy;
+class TreeSearchSpace;
 
 namespace utils {
 class LogProxy;
 }
 
-class TreeSearchNode{
-    State state;
+/*
+  A TreeSearchNode bundles the ID of a state with a reference to the
+  tree search space that stores the data of the node. It is cheap to
+  create and not intended for long term storage.
+*/
+class TreeSearchNode {
+    TreeSearchSpace &space;
+    StateID id;
     TreeSearchNodeInfo &info;
 public:
-    TreeSearchNode(const State &tstate, TreeSearchNodeInfo &tinfo);
-    const State &get_state() const;
+    TreeSearchNode(TreeSearchSpace &space, StateID id, TreeSearchNodeInfo &info);
+
+    StateID get_id() const;
+    State get_state() const;
 
     bool is_new() const;
     bool is_open() const;
@@ -31,17 +45,31 @@ public:
 
     int get_g() const;
     int get_real_g() const;
-    vector<StateID> get_children();
-    void add_child(StateID &id);
-    StateID get_parent();
-    OperatorID get_operator();
+    /*
+      The returned span stays valid until the next call to add_child on
+      any node of the same tree search space.
+    */
+    StateIDSpan get_children() const;
+    // Returns false if the node already has the child or it is its parent.
+    bool add_child(StateID id);
+    StateID get_parent() const;
+    /*
+      Parents other than the one returned by get_parent, which only exist
+      in DAG mode. The parent returned by get_parent is the one on the
+      cheapest known path to the node, and its creating operator is the
+      operator returned by get_operator.
+    */
+    StateIDSpan get_extra_parents() const;
+    void add_extra_parent(StateID parent_id);
+    void remove_extra_parent(StateID parent_id);
+    OperatorID get_operator() const;
     void remove_child(StateID id);
     void open_initial(int h);
-    int get_best_h();
+    int get_best_h() const;
     void set_best_h(int new_best_h);
     void open(const TreeSearchNode &parent_node,
               const OperatorProxy &parent_op,
-              int adjusted_cost);
+              int adjusted_cost, int h);
     void reopen(const TreeSearchNode &parent_node,
                 const OperatorProxy &parent_op,
                 int adjusted_cost);
@@ -51,22 +79,158 @@ public:
     void close();
     void mark_as_dead_end();
     void update_g(int g_diff);
-    
+
     void dump(const TaskProxy &task_proxy, utils::LogProxy &log) const;
 };
 
 
-class TreeSearchSpace{
-    PerStateInformation<TreeSearchNodeInfo> search_node_infos;
+/*
+  TreeSearchSpace stores the nodes of a tree search for the states of one
+  state registry, indexed by StateID.
+
+  The data that is read for every child during selection and
+  back-propagation (status, best_h, parent, real_g and the selection
+  statistics) is kept in dense arrays (struct of arrays), so choosing the child with minimal best_h is
+  a linear scan over the child IDs of a node without materializing any
+  State objects. The remaining per-node data lives in a segmented vector
+  of TreeSearchNodeInfo and the child lists live in a TreeChildArena.
+*/
+class TreeSearchSpace {
+    friend class TreeSearchNode;
+
+    std::vector<std::uint8_t> statuses;
+    std::vector<int> best_h_values;
+    std::vector<StateID> parents;
+    std::vector<int> real_g_values;
+    std::vector<int> virtual_losses;
+    std::vector<int> visit_counts;
+    std::vector<float> average_h_values;
+
+    segmented_vector::SegmentedVector<TreeSearchNodeInfo> node_infos;
+    TreeChildArena child_arena;
+    TreeChildArena extra_parent_arena;
+
     StateRegistry &state_registry;
     utils::LogProxy &log;
+
+    // Scratch buffer for collapse.
+    std::vector<StateID> removal_stack;
+
+    void resize_to_registry();
 public:
     TreeSearchSpace(StateRegistry &state_registry, utils::LogProxy &log);
 
     TreeSearchNode get_node(const State &state);
+    TreeSearchNode get_node(StateID id);
+
+    /*
+      The following accessors read the dense arrays directly. They may
+      only be called for states that have been accessed via get_node
+      before, e.g., the children of a node.
+    */
+    bool is_open(StateID id) const {
+        return statuses[id.value] == SearchNodeInfo::OPEN;
+    }
+
+    bool is_dead_end(StateID id) const {
+        return statuses[id.value] == SearchNodeInfo::DEAD_END;
+    }
+
+    int get_best_h(StateID id) const {
+        return best_h_values[id.value];
+    }
+
+    StateID get_parent(StateID id) const {
+        return parents[id.value];
+    }
+
+    StateIDSpan get_children(StateID id) const {
+        return child_arena.get_children(node_infos[id.value].children);
+    }
+
+    StateIDSpan get_extra_parents(StateID id) const {
+        return extra_parent_arena.get_children(
+            node_infos[id.value].extra_parents);
+    }
+
+    /*
+      Search graphs with transpositions (DAG mode) only contain edges from
+      nodes to nodes with larger state IDs. New nodes are always
+      registered after their parent, so this holds for all edges to new
+      nodes, and it guarantees that the graph has no cycles. Processing
+      nodes in decreasing order of their IDs visits all children of a node
+      before the node itself.
+    */
+    bool is_forward_edge(StateID from, StateID to) const {
+        return from.value < to.value;
+    }
+
+    /*
+      The virtual loss of a node counts the worker threads of a parallel
+      tree search that currently have the node on their selection path or
+      are evaluating it. It is always 0 in single-threaded searches.
+    */
+    int get_virtual_loss(StateID id) const {
+        return virtual_losses[id.value];
+    }
+
+    void add_virtual_loss(StateID id, int amount) {
+        virtual_losses[id.value] += amount;
+        assert(virtual_losses[id.value] >= 0);
+    }
+
+    /*
+      The visit count of a node is the number of h values that have been
+      sampled in its subtree, i.e., the number of evaluated nodes below it
+      (including itself) that are not dead ends. The average h value is
+      the mean of these h values.
+    */
+    int get_num_visits(StateID id) const {
+        return visit_counts[id.value];
+    }
+
+    double get_average_h(StateID id) const {
+        return average_h_values[id.value];
+    }
+
+    void add_h_samples(StateID id, int num_samples, double sum_h) {
+        if (num_samples == 0) {
+            return;
+        }
+        int old_visits = visit_counts[id.value];
+        int new_visits = old_visits + num_samples;
+        average_h_values[id.value] = static_cast<float>(
+            (average_h_values[id.value] * old_visits + sum_h) / new_visits);
+        visit_counts[id.value] = new_visits;
+    }
+
     void trace_path(const State &goal_state,
                     std::vector<OperatorID> &path) const;
 
+    /*
+      Remove all descendants of the given node from the tree and release
+      their child lists. Their states become new again. A closed node
+      becomes an open leaf that keeps its best_h and selection
+      statistics; a dead end stays a dead end. The subtree must not
+      contain nodes with extra parents or virtual loss. Returns the number
+      of removed nodes.
+    */
+    int collapse(StateID id);
+
+    // Return the number of nodes that are not new.
+    std::size_t count_nodes() const;
+
+    /*
+      Reclaim the arena slots that were abandoned by collapse and by
+      relocating blocks. If compact_registry is true, also remove all
+      states from the state registry that are new in this search space
+      (see StateRegistry::compact) and renumber the nodes accordingly.
+      The relative order of the nodes is preserved.
+    */
+    void compact(bool compact_registry);
+
+    std::size_t estimate_memory_in_bytes() const;
+
     void dump(const TaskProxy &task_proxy) const;
     void print_statistics() const;
 };
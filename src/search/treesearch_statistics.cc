@@ -0,0 +1,148 @@
+#include "treesearch_statistics.h"
+
+#include "utils/logging.h"
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+
+using namespace std;
+
+static const char *phase_names[] = {
+    "selection", "expansion", "evaluation", "backup", "lock waiting"
+};
+
+static_assert(
+    sizeof(phase_names) / sizeof(phase_names[0]) ==
+    TreeSearchStatistics::NUM_PHASES,
+    "Every phase needs a name.");
+
+TreeSearchStatistics::TreeSearchStatistics(
+    utils::LogProxy &log, double report_interval)
+    : log(log),
+      report_interval(report_interval),
+      start_time(Clock::now()),
+      last_report_time(start_time),
+      iterations_at_last_report(0),
+      num_iterations(0),
+      total_selection_depth(0),
+      max_selection_depth(0),
+      num_selection_collisions(0),
+      num_expansions(0),
+      num_successors(0),
+      num_new_children(0),
+      best_h(INT_MAX) {
+    phase_times.fill(0);
+}
+
+double TreeSearchStatistics::lap(Clock::time_point &phase_start) {
+    Clock::time_point now = Clock::now();
+    double seconds = chrono::duration<double>(now - phase_start).count();
+    phase_start = now;
+    return seconds;
+}
+
+double TreeSearchStatistics::get_elapsed_seconds(Clock::time_point since) const {
+    return chrono::duration<double>(Clock::now() - since).count();
+}
+
+void TreeSearchStatistics::inc_iterations(int selection_depth) {
+    ++num_iterations;
+    total_selection_depth += selection_depth;
+    max_selection_depth = max(max_selection_depth, selection_depth);
+}
+
+void TreeSearchStatistics::report_expansion(int successors, int new_children) {
+    ++num_expansions;
+    num_successors += successors;
+    num_new_children += new_children;
+}
+
+void TreeSearchStatistics::report_h_value(int h) {
+    if (h < best_h) {
+        best_h = h;
+        double seconds = get_elapsed_seconds(start_time);
+        best_h_history.emplace_back(seconds, h);
+        if (log.is_at_least_normal()) {
+            log << "New best heuristic value: " << h
+                << " [" << num_iterations << " iterations, "
+                << seconds << "s]" << endl;
+        }
+    }
+}
+
+bool TreeSearchStatistics::is_report_due() const {
+    return get_elapsed_seconds(last_report_time) >= report_interval;
+}
+
+void TreeSearchStatistics::print_phase_fractions() const {
+    double total_time = accumulate(phase_times.begin(), phase_times.end(), 0.0);
+    for (int phase = 0; phase < NUM_PHASES; ++phase) {
+        double fraction = (total_time > 0) ? phase_times[phase] / total_time : 0;
+        log << (phase == 0 ? "" : ", ") << phase_names[phase] << " "
+            << static_cast<int>(100 * fraction + 0.5) << "%";
+    }
+}
+
+void TreeSearchStatistics::print_progress_line(size_t tree_memory_in_bytes) {
+    Clock::time_point now = Clock::now();
+    double interval = chrono::duration<double>(now - last_report_time).count();
+    long long interval_iterations = num_iterations - iterations_at_last_report;
+    if (log.is_at_least_normal()) {
+        log << num_iterations << " iterations";
+        if (interval > 0) {
+            log << " (" << interval_iterations / interval << "/s)";
+        }
+        if (num_iterations > 0) {
+            log << ", average depth "
+                << static_cast<double>(total_selection_depth) / num_iterations;
+        }
+        if (num_expansions > 0) {
+            log << ", branching factor "
+                << static_cast<double>(num_successors) / num_expansions;
+        }
+        if (best_h != INT_MAX) {
+            log << ", best h " << best_h;
+        }
+        log << ", tree " << tree_memory_in_bytes / 1024 << " KB, time: ";
+        print_phase_fractions();
+        log << endl;
+    }
+    last_report_time = now;
+    iterations_at_last_report = num_iterations;
+}
+
+void TreeSearchStatistics::print_detailed_statistics() const {
+    log << "MCTS iterations: " << num_iterations << endl;
+    double seconds = get_elapsed_seconds(start_time);
+    if (seconds > 0) {
+        log << "MCTS iterations per second: " << num_iterations / seconds << endl;
+    }
+    if (num_iterations > 0) {
+        log << "Average selection path length: "
+            << static_cast<double>(total_selection_depth) / num_iterations
+            << endl;
+    }
+    log << "Maximum selection path length: " << max_selection_depth << endl;
+    if (num_selection_collisions > 0) {
+        log << "Selection collisions: " << num_selection_collisions << endl;
+    }
+    if (num_expansions > 0) {
+        log << "Average branching factor: "
+            << static_cast<double>(num_successors) / num_expansions << endl;
+        log << "Average new children per expansion: "
+            << static_cast<double>(num_new_children) / num_expansions << endl;
+    }
+    for (int phase = 0; phase < NUM_PHASES; ++phase) {
+        log << "Time in " << phase_names[phase] << ": "
+            << phase_times[phase] << "s" << endl;
+    }
+    log << "Time fractions: ";
+    print_phase_fractions();
+    log << endl;
+    log << "Best heuristic value over time:";
+    for (const pair<double, int> &entry : best_h_history) {
+        log << " " << entry.second << "@" << entry.first << "s";
+    }
+    log << endl;
+}
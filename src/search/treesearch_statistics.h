@@ -0,0 +1,93 @@
+#ifndef TREESEARCH_STATISTICS_H
+#define TREESEARCH_STATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace utils {
+class LogProxy;
+}
+
+/*
+  This class keeps track of the statistics of tree search engines that
+  complement the SearchStatistics of the engine: the number of iterations
+  (selection, expansion, evaluation and back-propagation of one leaf),
+  the selection depth, the branching factor of expansions, the time spent
+  in every phase of an iteration and the best heuristic value over time.
+
+  It prints a progress line at a configurable interval and the summary in
+  print_detailed_statistics. Times are wall-clock times summed over all
+  threads, so with several threads the phase times add up to roughly the
+  number of threads times the search time.
+
+  The class is not thread-safe. Parallel engines must only call its
+  methods while holding the lock that guards their tree.
+*/
+class TreeSearchStatistics {
+public:
+    enum Phase {
+        SELECTION,
+        EXPANSION,
+        EVALUATION,
+        BACKUP,
+        // Time that threads wait for the tree lock.
+        LOCK_WAIT,
+        NUM_PHASES
+    };
+
+    using Clock = std::chrono::steady_clock;
+private:
+    utils::LogProxy &log;
+    double report_interval;
+    Clock::time_point start_time;
+    Clock::time_point last_report_time;
+    long long iterations_at_last_report;
+
+    long long num_iterations;
+    long long total_selection_depth;
+    int max_selection_depth;
+    int num_selection_collisions;
+    long long num_expansions;
+    long long num_successors;
+    long long num_new_children;
+    std::array<double, NUM_PHASES> phase_times;
+
+    int best_h;
+    // Pairs of seconds since the start and new best h values.
+    std::vector<std::pair<double, int>> best_h_history;
+
+    double get_elapsed_seconds(Clock::time_point since) const;
+    void print_phase_fractions() const;
+public:
+    TreeSearchStatistics(utils::LogProxy &log, double report_interval);
+
+    /*
+      Return the time since the given time point in seconds and set the
+      time point to the current time. Use this to measure consecutive
+      phases, also outside of the lock.
+    */
+    static double lap(Clock::time_point &phase_start);
+
+    void inc_iterations(int selection_depth);
+    void inc_selection_collisions() {++num_selection_collisions;}
+    void report_expansion(int successors, int new_children);
+    void add_phase_time(Phase phase, double seconds) {
+        phase_times[phase] += seconds;
+    }
+
+    /*
+      Call with the heuristic value of every evaluated node that is not a
+      dead end. Prints a line whenever the value is a new minimum.
+    */
+    void report_h_value(int h);
+
+    // Return true if the report interval has passed since the last report.
+    bool is_report_due() const;
+    void print_progress_line(std::size_t tree_memory_in_bytes);
+    void print_detailed_statistics() const;
+};
+
+#endif
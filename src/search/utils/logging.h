@@ -4,9 +4,14 @@
 #include "system.h"
 #include "timer.h"
 
+#include <iostream>
 #include <memory>
+#include <mutex>
 #include <ostream>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace options {
@@ -28,37 +33,54 @@ enum class Verbosity {
   of output. Lines should be eventually terminated by endl. Logs are written to
   stdout.
 
+  Several threads may write to the same log (e.g., the searches of a parallel
+  portfolio). Therefore every thread assembles its current line separately,
+  and the line is written to the stream at endl under a lock, so the lines of
+  different threads do not interleave.
+
   Internal class encapsulated by LogProxy.
 */
 class Log {
+    struct Line {
+        std::ostringstream text;
+        bool has_started = false;
+    };
+
     std::ostream &stream;
     const Verbosity verbosity;
-    bool line_has_started;
+    std::mutex mutex;
+    std::unordered_map<std::thread::id, Line> lines;
 
 public:
     explicit Log(Verbosity verbosity)
-        : stream(std::cout), verbosity(verbosity), line_has_started(false) {
+        : stream(std::cout), verbosity(verbosity) {
     }
 
     template<typename T>
     Log &operator<<(const T &elem) {
-        if (!line_has_started) {
-            line_has_started = true;
-            stream << "[t=" << g_timer << ", "
-                   << get_peak_memory_in_kb() << " KB] ";
+        std::lock_guard<std::mutex> lock(mutex);
+        Line &line = lines[std::this_thread::get_id()];
+        if (!line.has_started) {
+            line.has_started = true;
+            line.text << "[t=" << g_timer << ", "
+                      << get_peak_memory_in_kb() << " KB] ";
         }
 
-        stream << elem;
+        line.text << elem;
         return *this;
     }
 
     using manip_function = std::ostream &(*)(std::ostream &);
     Log &operator<<(manip_function f) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Line &line = lines[std::this_thread::get_id()];
         if (f == static_cast<manip_function>(&std::endl)) {
-            line_has_started = false;
+            stream << line.text.str() << f;
+            line.text.str("");
+            line.has_started = false;
+        } else {
+            line.text << f;
         }
-
-        stream << f;
         return *this;
     }
 
@@ -0,0 +1,120 @@
+#include "mapped_file_pool.h"
+
+#include "system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#if OPERATING_SYSTEM == LINUX || OPERATING_SYSTEM == OSX
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace utils {
+MappedFilePool::MappedFilePool(const string &directory, size_t max_size_in_bytes)
+    : max_size_in_bytes(max_size_in_bytes),
+      file_descriptor(-1),
+      file_size(0),
+      num_used_bytes_in_last_chunk(0),
+      num_allocated_blocks(0) {
+#if OPERATING_SYSTEM == LINUX || OPERATING_SYSTEM == OSX
+    string pattern = directory + "/downward-pool-XXXXXX";
+    vector<char> filename(pattern.begin(), pattern.end());
+    filename.push_back('\0');
+    file_descriptor = mkstemp(filename.data());
+    if (file_descriptor == -1) {
+        cerr << "Could not create a memory-mapped file in " << directory
+             << ": " << strerror(errno) << endl;
+        exit_with(ExitCode::SEARCH_INPUT_ERROR);
+    }
+    // The file stays accessible through the descriptor until it is closed.
+    unlink(filename.data());
+#else
+    cerr << "Memory-mapped files are only supported on Linux and macOS." << endl;
+    exit_with(ExitCode::SEARCH_UNSUPPORTED);
+#endif
+}
+
+MappedFilePool::~MappedFilePool() {
+#if OPERATING_SYSTEM == LINUX || OPERATING_SYSTEM == OSX
+    for (const pair<char *, size_t> &chunk : chunks) {
+        munmap(chunk.first, chunk.second);
+    }
+    close(file_descriptor);
+#endif
+}
+
+void MappedFilePool::add_chunk() {
+#if OPERATING_SYSTEM == LINUX || OPERATING_SYSTEM == OSX
+    size_t chunk_size = min(CHUNK_BYTES, max_size_in_bytes - file_size);
+    chunk_size -= chunk_size % BLOCK_BYTES;
+    if (chunk_size == 0) {
+        cerr << "Memory-mapped file reached its maximum size." << endl;
+        exit_with(ExitCode::SEARCH_OUT_OF_MEMORY);
+    }
+#if OPERATING_SYSTEM == LINUX
+    /*
+      Reserve the disk space now. Otherwise, running out of disk space
+      would only show when a page is written back (SIGBUS).
+    */
+    int error = posix_fallocate(file_descriptor, file_size, chunk_size);
+#else
+    int error = ftruncate(file_descriptor, file_size + chunk_size) ? errno : 0;
+#endif
+    if (error) {
+        cerr << "Could not grow memory-mapped file: " << strerror(error) << endl;
+        exit_with(ExitCode::SEARCH_OUT_OF_MEMORY);
+    }
+    void *chunk = mmap(nullptr, chunk_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, file_descriptor, file_size);
+    if (chunk == MAP_FAILED) {
+        cerr << "Could not map memory-mapped file: " << strerror(errno) << endl;
+        exit_with(ExitCode::SEARCH_OUT_OF_MEMORY);
+    }
+    chunks.emplace_back(static_cast<char *>(chunk), chunk_size);
+    file_size += chunk_size;
+    num_used_bytes_in_last_chunk = 0;
+#endif
+}
+
+void *MappedFilePool::allocate_block() {
+    lock_guard<mutex> lock(pool_mutex);
+    ++num_allocated_blocks;
+    if (!free_blocks.empty()) {
+        void *block = free_blocks.back();
+        free_blocks.pop_back();
+        return block;
+    }
+    if (chunks.empty() ||
+        num_used_bytes_in_last_chunk + BLOCK_BYTES > chunks.back().second) {
+        add_chunk();
+    }
+    void *block = chunks.back().first + num_used_bytes_in_last_chunk;
+    num_used_bytes_in_last_chunk += BLOCK_BYTES;
+    return block;
+}
+
+void MappedFilePool::free_block(void *block) {
+    lock_guard<mutex> lock(pool_mutex);
+    assert(num_allocated_blocks > 0);
+    --num_allocated_blocks;
+    free_blocks.push_back(block);
+}
+
+size_t MappedFilePool::get_file_size() const {
+    lock_guard<mutex> lock(pool_mutex);
+    return file_size;
+}
+
+size_t MappedFilePool::get_num_allocated_blocks() const {
+    lock_guard<mutex> lock(pool_mutex);
+    return num_allocated_blocks;
+}
+}
@@ -0,0 +1,111 @@
+#ifndef UTILS_MAPPED_FILE_POOL_H
+#define UTILS_MAPPED_FILE_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace utils {
+/*
+  MappedFilePool hands out fixed-size blocks of memory that live in a
+  memory-mapped file instead of anonymous memory. The operating system
+  can write the pages of such blocks back to the file and drop them from
+  RAM when memory gets scarce, so data structures that allocate their
+  segments here can grow beyond the physical memory. Accessing data that
+  was dropped from RAM costs a page fault, so the file should be on a
+  fast local disk.
+
+  The file is created in the given directory and unlinked immediately, so
+  it is removed when the planner terminates. It grows in chunks of
+  CHUNK_BYTES up to the given maximum size. If the maximum size is
+  reached, the planner exits with SEARCH_OUT_OF_MEMORY. Freed blocks are
+  reused.
+
+  Mapped chunks count towards address space limits (ulimit -v), so such a
+  limit must leave room for the file. All methods can be called from
+  several threads at once. Memory-mapped files are only supported on
+  Linux and macOS.
+*/
+class MappedFilePool {
+public:
+    static const std::size_t BLOCK_BYTES = 8192;
+private:
+    static const std::size_t CHUNK_BYTES = 64 * 1024 * 1024;
+
+    const std::size_t max_size_in_bytes;
+    int file_descriptor;
+    std::size_t file_size;
+    std::vector<std::pair<char *, std::size_t>> chunks;
+    std::size_t num_used_bytes_in_last_chunk;
+    std::vector<void *> free_blocks;
+    std::size_t num_allocated_blocks;
+    mutable std::mutex pool_mutex;
+
+    void add_chunk();
+public:
+    MappedFilePool(const std::string &directory, std::size_t max_size_in_bytes);
+    ~MappedFilePool();
+
+    MappedFilePool(const MappedFilePool &) = delete;
+    MappedFilePool &operator=(const MappedFilePool &) = delete;
+
+    void *allocate_block();
+    void free_block(void *block);
+
+    std::size_t get_file_size() const;
+    std::size_t get_num_allocated_blocks() const;
+};
+
+/*
+  Allocator that takes memory for arrays of up to BLOCK_BYTES bytes from
+  a MappedFilePool and falls back to the standard allocator for larger
+  arrays or if no pool is given. Segmented vectors use it to keep their
+  segments on disk.
+*/
+template<typename T>
+class MappedFileAllocator : public std::allocator<T> {
+    template<typename U>
+    friend class MappedFileAllocator;
+
+    std::shared_ptr<MappedFilePool> pool;
+
+    bool uses_pool(std::size_t n) const {
+        return pool && n * sizeof(T) <= MappedFilePool::BLOCK_BYTES;
+    }
+public:
+    template<typename U>
+    struct rebind {
+        using other = MappedFileAllocator<U>;
+    };
+
+    explicit MappedFileAllocator(
+        const std::shared_ptr<MappedFilePool> &pool = nullptr)
+        : pool(pool) {
+    }
+
+    template<typename U>
+    MappedFileAllocator(const MappedFileAllocator<U> &other)
+        : pool(other.pool) {
+    }
+
+    T *allocate(std::size_t n) {
+        if (uses_pool(n)) {
+            return static_cast<T *>(pool->allocate_block());
+        }
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) {
+        if (uses_pool(n)) {
+            pool->free_block(p);
+        } else {
+            std::allocator<T>::deallocate(p, n);
+        }
+    }
+};
+}
+
+#endif